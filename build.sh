@@ -9,7 +9,6 @@ sleep 1
 # Step 2 Copy files
 echo [INFO] Copy Files
 cp ./SimTop.v ./build/test/
-mv ./SimTop.AXI4Ram* ./build/test
 sleep 1
 
 # Step 3 Change directory
@@ -17,7 +16,8 @@ cd ./build/test/
 
 # Step 4 Verilator compiling
 echo [INFO] Verilator Compiling ....
-verilator --trace --cc SimTop.v --exe sim.cpp
+verilator --trace-fst --savable --cc SimTop.v ram.v db.v evlog.v --exe sim.cpp emu.cpp ram.cpp snapshot.cpp trace.cpp pmu.cpp \
+  db.cpp chisel_db.cpp evlog.cpp evlog_events.cpp difftest.cpp interp.cpp -CFLAGS "-DVL_USER_STOP -DVL_USER_FATAL" -LDFLAGS "-lz -lsqlite3 -pthread"
 sleep 1
 
 # Step 5 Make
@@ -26,4 +26,4 @@ make -C obj_dir -f VSimTop.mk VSimTop
 sleep 1
 
 # Step 6 Run
-./obj_dir/VSimTop
+./obj_dir/VSimTop "$@"
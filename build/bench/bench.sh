@@ -0,0 +1,101 @@
+#!/usr/bin/bash
+#
+# Simulation speed benchmark.
+#
+# Runs every kernel in kernels/ on every built emulator profile and reports
+# simulated cycles/sec and host instructions per simulated cycle (needs
+# perf). Results go to bench.csv.
+#
+# Usage: bench.sh [-b baseline.csv] [-t tolerance] [emu ...]
+#   emu         emulator binaries, default: every build/test/obj_dir*/VSimTop
+#   -b FILE     compare against an earlier bench.csv, fail on regressions
+#   -t RATIO    allowed slowdown against the baseline (default: 0.05)
+
+BENCH_DIR=$(cd "$(dirname "$0")"; pwd)
+TEST_DIR=$(cd "$BENCH_DIR/../test"; pwd)
+OUT=bench.csv
+BASELINE=
+TOLERANCE=0.05
+
+while getopts "b:t:" opt; do
+  case $opt in
+    b) BASELINE=$OPTARG ;;
+    t) TOLERANCE=$OPTARG ;;
+    *) exit 1 ;;
+  esac
+done
+shift $((OPTIND - 1))
+
+EMUS=("$@")
+if [ ${#EMUS[@]} -eq 0 ]; then
+  EMUS=($(ls "$TEST_DIR"/obj_dir*/VSimTop 2>/dev/null))
+fi
+if [ ${#EMUS[@]} -eq 0 ]; then
+  echo [ERROR] No emulator found, build one with make emu-verilator/emu-notrace/emu-mt/emu-pgo
+  exit 1
+fi
+
+PERF=
+if perf stat -e instructions:u true > /dev/null 2>&1; then
+  PERF=perf
+else
+  echo [WARN] perf is not usable, host instructions per cycle will not be reported
+fi
+
+LOG=$(mktemp)
+PERF_LOG=$(mktemp)
+trap 'rm -f "$LOG" "$PERF_LOG"' EXIT
+
+echo "profile,kernel,status,cycles,instrs,ipc,seconds,khz,host_instrs_per_cycle" > $OUT
+printf "%-16s %-10s %-6s %10s %8s %10s %12s\n" profile kernel status cycles ipc kHz host-inst/cyc
+
+failed=0
+for emu in "${EMUS[@]}"; do
+  profile=$(basename "$(dirname "$emu")")
+  for kernel in "$BENCH_DIR"/kernels/*.bin; do
+    name=$(basename "$kernel" .bin)
+    if [ -n "$PERF" ]; then
+      perf stat -x, -e instructions:u -o "$PERF_LOG" -- "$emu" -i "$kernel" > "$LOG" 2>&1
+    else
+      "$emu" -i "$kernel" > "$LOG" 2>&1
+    fi
+    if [ $? -eq 0 ]; then
+      status=pass
+    else
+      status=fail
+      failed=1
+    fi
+
+    cycles=$(sed -n 's/.*Cycles: \([0-9]*\),.*/\1/p' "$LOG")
+    instrs=$(sed -n 's/.*Instructions: \([0-9]*\),.*/\1/p' "$LOG")
+    ipc=$(sed -n 's/.*IPC: \([0-9.]*\).*/\1/p' "$LOG")
+    seconds=$(sed -n 's/.*Host time: \([0-9.]*\) s.*/\1/p' "$LOG")
+    khz=$(sed -n 's/.*s, \([0-9.]*\) kHz.*/\1/p' "$LOG")
+    hipc=-
+    if [ -n "$PERF" ] && [ -n "$cycles" ] && [ "$cycles" -gt 0 ]; then
+      host=$(grep instructions "$PERF_LOG" | cut -d, -f1)
+      hipc=$(awk -v h="$host" -v c="$cycles" 'BEGIN { printf "%.0f", h / c }')
+    fi
+
+    echo "$profile,$name,$status,$cycles,$instrs,$ipc,$seconds,$khz,$hipc" >> $OUT
+    printf "%-16s %-10s %-6s %10s %8s %10s %12s\n" "$profile" "$name" "$status" "$cycles" "$ipc" "$khz" "$hipc"
+  done
+done
+
+if [ $failed -ne 0 ]; then
+  echo [ERROR] Some kernels did not hit a good trap
+  exit 1
+fi
+
+#  A kernel regresses when its kHz drops below (1 - tolerance) of the baseline.
+if [ -n "$BASELINE" ]; then
+  awk -F, -v tol="$TOLERANCE" '
+    NR == FNR { if (FNR > 1) base[$1 "," $2] = $8; next }
+    FNR > 1 && ($1 "," $2) in base && $8 < base[$1 "," $2] * (1 - tol) {
+      printf "[ERROR] %s/%s: %.3f kHz, baseline %.3f kHz\n", $1, $2, $8, base[$1 "," $2]
+      bad = 1
+    }
+    END { exit bad }
+  ' "$BASELINE" $OUT || exit 1
+  echo [INFO] No regression against $BASELINE
+fi
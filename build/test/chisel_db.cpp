@@ -0,0 +1,24 @@
+//  Generated by ChiselDB, do not edit.
+
+#include "chisel_db.h"
+
+const DBTable db_tables[] = {
+  { "TLBRefill", 8, { "vaddr", "asid", "prv", "level", "ppn", "perm", "way", "set" } },
+  { "CacheRefill", 3, { "addr", "way", "set" } },
+  { "Commit", 8, { "pc", "rob_id", "uopc", "rvc", "rd_valid", "rd", "taken", "target" } },
+  { NULL, 0, {} }
+};
+const int db_nr_tables = 3;
+
+const char *const db_sites[] = {
+  "ITLB",
+  "ICache",
+  "DTLB",
+  "DCache",
+  "ROB_0",
+  "ROB_1",
+  "ROB_2",
+  "ROB_3",
+  NULL
+};
+const int db_nr_sites = 8;
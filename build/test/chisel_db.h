@@ -0,0 +1,12 @@
+#ifndef __CHISEL_DB_H__
+#define __CHISEL_DB_H__
+
+//  Generated by ChiselDB, do not edit.
+
+#include "db.h"
+
+#define DB_TABLE_TLBREFILL 0
+#define DB_TABLE_CACHEREFILL 1
+#define DB_TABLE_COMMIT 2
+
+#endif
@@ -0,0 +1,186 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <sqlite3.h>
+
+#include "db.h"
+
+#define DB_QUEUE_SIZE   (1UL << 16)   //  Rows, power of two
+#define DB_BATCH_ROWS   (1UL << 14)   //  Rows per transaction
+#define DB_FLUSH_MS     1000          //  Commit a partial batch after this long
+
+struct DBRow {
+  int32_t table;
+  int32_t site;
+  uint64_t stamp;
+  uint64_t data[DB_MAX_COLS];
+};
+
+static bool db_enable = false;
+static sqlite3 *db = NULL;
+static sqlite3_stmt **db_stmts = NULL;
+
+//  Single producer (the simulation thread), single consumer (the writer).
+static DBRow *db_queue = NULL;
+static std::atomic<uint64_t> db_head(0);
+static std::atomic<uint64_t> db_tail(0);
+static std::atomic<bool> db_stop(false);
+static uint64_t db_tail_seen = 0;       //  Producer's copy of db_tail
+static uint64_t db_nr_waits = 0;
+static std::thread db_thread;
+
+static void db_exec(const char *sql) {
+  char *err = NULL;
+  if (sqlite3_exec(db, sql, NULL, NULL, &err) != SQLITE_OK) {
+    printf("[ERROR] ChiselDB: %s: %s\n", sql, err);
+    sqlite3_free(err);
+  }
+}
+
+static void db_insert(const DBRow &row) {
+  sqlite3_stmt *stmt = db_stmts[row.table];
+  sqlite3_bind_int64(stmt, 1, row.stamp);
+  sqlite3_bind_text(stmt, 2, db_sites[row.site], -1, SQLITE_STATIC);
+  for (int i = 0; i < db_tables[row.table].nr_cols; i++) {
+    sqlite3_bind_int64(stmt, i + 3, row.data[i]);
+  }
+  if (sqlite3_step(stmt) != SQLITE_DONE) {
+    printf("[ERROR] ChiselDB: insert into %s: %s\n", db_tables[row.table].name, sqlite3_errmsg(db));
+  }
+  sqlite3_reset(stmt);
+}
+
+//  Drain the queue in batches. A partial batch is committed once it is
+//  DB_FLUSH_MS old, so the file on disk never lags far behind the run.
+static void db_writer() {
+  using clock = std::chrono::steady_clock;
+  uint64_t tail = 0;
+  uint64_t batch = 0;
+  clock::time_point last_commit = clock::now();
+
+  db_exec("BEGIN");
+  for (;;) {
+    bool stop = db_stop.load(std::memory_order_acquire);
+    uint64_t head = db_head.load(std::memory_order_acquire);
+    while (tail != head) {
+      db_insert(db_queue[tail & (DB_QUEUE_SIZE - 1)]);
+      db_tail.store(++tail, std::memory_order_release);
+      if (++batch == DB_BATCH_ROWS) {
+        db_exec("COMMIT; BEGIN");
+        batch = 0;
+        last_commit = clock::now();
+      }
+    }
+    if (stop) {
+      break;
+    }
+    if (batch && clock::now() - last_commit >= std::chrono::milliseconds(DB_FLUSH_MS)) {
+      db_exec("COMMIT; BEGIN");
+      batch = 0;
+      last_commit = clock::now();
+    }
+    usleep(1000);
+  }
+  db_exec("COMMIT");
+}
+
+void init_db(const char *file) {
+  if (file == NULL) {
+    return;
+  }
+  //  A crashed run leaves its WAL behind, SQLite would replay it into the new file.
+  unlink(file);
+  unlink((std::string(file) + "-wal").c_str());
+  unlink((std::string(file) + "-shm").c_str());
+  if (sqlite3_open(file, &db) != SQLITE_OK) {
+    printf("[ERROR] Cannot open database %s: %s\n", file, sqlite3_errmsg(db));
+    exit(1);
+  }
+  //  WAL with NORMAL sync: committed batches survive the simulator crashing.
+  db_exec("PRAGMA journal_mode=WAL");
+  db_exec("PRAGMA synchronous=NORMAL");
+
+  db_stmts = new sqlite3_stmt *[db_nr_tables];
+  for (int t = 0; t < db_nr_tables; t++) {
+    const DBTable &table = db_tables[t];
+    std::string create = std::string("CREATE TABLE \"") + table.name +
+                         "\"(ID INTEGER PRIMARY KEY, STAMP INT NOT NULL, SITE TEXT";
+    std::string insert = std::string("INSERT INTO \"") + table.name + "\"(STAMP, SITE";
+    std::string values = "VALUES(?, ?";
+    for (int i = 0; i < table.nr_cols; i++) {
+      create += std::string(", \"") + table.cols[i] + "\" INT NOT NULL";
+      insert += std::string(", \"") + table.cols[i] + "\"";
+      values += ", ?";
+    }
+    create += ")";
+    insert += ") " + values + ")";
+    db_exec(create.c_str());
+    if (sqlite3_prepare_v2(db, insert.c_str(), -1, &db_stmts[t], NULL) != SQLITE_OK) {
+      printf("[ERROR] ChiselDB: %s: %s\n", insert.c_str(), sqlite3_errmsg(db));
+      exit(1);
+    }
+  }
+
+  db_queue = new DBRow[DB_QUEUE_SIZE];
+  db_thread = std::thread(db_writer);
+  db_enable = true;
+  //  Error paths call exit(): join the writer before the joinable
+  //  std::thread is destroyed, and keep the last batch.
+  atexit(db_finish);
+  printf("[INFO] Logging %d ChiselDB tables to %s\n", db_nr_tables, file);
+}
+
+void db_finish() {
+  if (!db_enable) {
+    return;
+  }
+  db_enable = false;
+  db_stop.store(true, std::memory_order_release);
+  db_thread.join();
+
+  for (int t = 0; t < db_nr_tables; t++) {
+    sqlite3_finalize(db_stmts[t]);
+  }
+  sqlite3_close(db);
+  delete[] db_stmts;
+  delete[] db_queue;
+  printf("[INFO] ChiselDB: %lu rows, simulation waited on a full queue %lu times\n",
+         db_head.load(), db_nr_waits);
+}
+
+extern "C" void db_write(int table, int site, uint64_t stamp,
+                         uint64_t d0, uint64_t d1, uint64_t d2, uint64_t d3,
+                         uint64_t d4, uint64_t d5, uint64_t d6, uint64_t d7) {
+  if (!db_enable) {
+    return;
+  }
+  uint64_t head = db_head.load(std::memory_order_relaxed);
+  if (head - db_tail_seen == DB_QUEUE_SIZE) {
+    db_tail_seen = db_tail.load(std::memory_order_acquire);
+    if (head - db_tail_seen == DB_QUEUE_SIZE) {
+      db_nr_waits++;
+      do {
+        std::this_thread::yield();
+        db_tail_seen = db_tail.load(std::memory_order_acquire);
+      } while (head - db_tail_seen == DB_QUEUE_SIZE);
+    }
+  }
+
+  DBRow &row = db_queue[head & (DB_QUEUE_SIZE - 1)];
+  row.table = table;
+  row.site = site;
+  row.stamp = stamp;
+  row.data[0] = d0;
+  row.data[1] = d1;
+  row.data[2] = d2;
+  row.data[3] = d3;
+  row.data[4] = d4;
+  row.data[5] = d5;
+  row.data[6] = d6;
+  row.data[7] = d7;
+  db_head.store(head + 1, std::memory_order_release);
+}
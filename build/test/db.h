@@ -0,0 +1,33 @@
+#ifndef __DB_H__
+#define __DB_H__
+
+#include <cstddef>
+#include <cstdint>
+
+//  ChiselDB event tables. Rows are queued by the DPI call and written to
+//  SQLite by a background thread, one transaction per batch, so a run that
+//  dies keeps everything up to the last commit.
+
+#define DB_MAX_COLS 8
+
+struct DBTable {
+  const char *name;
+  int nr_cols;
+  const char *cols[DB_MAX_COLS];
+};
+
+//  Schema, generated at elaboration into chisel_db.cpp
+extern const DBTable db_tables[];
+extern const int db_nr_tables;
+extern const char *const db_sites[];
+extern const int db_nr_sites;
+
+//  NULL disables logging, db_write() then returns at once.
+void init_db(const char *file);
+void db_finish();
+
+extern "C" void db_write(int table, int site, uint64_t stamp,
+                         uint64_t d0, uint64_t d1, uint64_t d2, uint64_t d3,
+                         uint64_t d4, uint64_t d5, uint64_t d6, uint64_t d7);
+
+#endif
@@ -0,0 +1,44 @@
+import "DPI-C" function void db_write
+(
+  input  int        table_id,
+  input  int        site,
+  input  longint    stamp,
+  input  longint    d0,
+  input  longint    d1,
+  input  longint    d2,
+  input  longint    d3,
+  input  longint    d4,
+  input  longint    d5,
+  input  longint    d6,
+  input  longint    d7
+);
+
+//  One instance per ChiselDB log site, see zircon.utils.ChiselDB.
+module DBWriter #(
+  parameter TABLE = 0,
+  parameter SITE = 0
+)(
+  input         clk,
+  input         en,
+  input  [63:0] data_0,
+  input  [63:0] data_1,
+  input  [63:0] data_2,
+  input  [63:0] data_3,
+  input  [63:0] data_4,
+  input  [63:0] data_5,
+  input  [63:0] data_6,
+  input  [63:0] data_7
+);
+
+  //  Cycle stamp, free running from time zero like the harness cycle count.
+  reg [63:0] stamp;
+  initial stamp = 0;
+
+  always @(posedge clk) begin
+    stamp <= stamp + 1;
+    if (en) begin
+      db_write(TABLE, SITE, stamp, data_0, data_1, data_2, data_3, data_4, data_5, data_6, data_7);
+    end
+  end
+
+endmodule
@@ -0,0 +1,278 @@
+#include <cstdio>
+#include <cstring>
+
+#include "difftest.h"
+#include "interp.h"
+
+#define DIFF_PC_MASK ((1UL << 39) - 1)    //  vaddrBits, retire pcs are zero-extended
+//  mstatus without FS/SD (FPU state is not modelled) and the XLEN fields.
+#define DIFF_MSTATUS_MASK 0x7e19aaUL
+//  SSIP and STIP, the other pending bits are wired to the CLINT and PLIC.
+#define DIFF_MIP_MASK     0x22UL
+
+#define RETIRE_PORTS(w) \
+  { &dut->io_retire_##w##_valid, &dut->io_retire_##w##_pc, &dut->io_retire_##w##_wen, \
+    &dut->io_retire_##w##_rd, &dut->io_retire_##w##_wdata, &dut->io_retire_##w##_csr },
+
+Difftest::Difftest(VSimTop *dut, bool enable, const char *img, uint64_t mem_size, uint64_t reset_vector)
+  : m_dut(dut), m_ref(NULL), m_enable(enable), m_ports{ SIM_FOR_EACH_RETIRE(RETIRE_PORTS) },
+    m_gpr{ &dut->io_diff_gpr_0,  &dut->io_diff_gpr_1,  &dut->io_diff_gpr_2,  &dut->io_diff_gpr_3,
+           &dut->io_diff_gpr_4,  &dut->io_diff_gpr_5,  &dut->io_diff_gpr_6,  &dut->io_diff_gpr_7,
+           &dut->io_diff_gpr_8,  &dut->io_diff_gpr_9,  &dut->io_diff_gpr_10, &dut->io_diff_gpr_11,
+           &dut->io_diff_gpr_12, &dut->io_diff_gpr_13, &dut->io_diff_gpr_14, &dut->io_diff_gpr_15,
+           &dut->io_diff_gpr_16, &dut->io_diff_gpr_17, &dut->io_diff_gpr_18, &dut->io_diff_gpr_19,
+           &dut->io_diff_gpr_20, &dut->io_diff_gpr_21, &dut->io_diff_gpr_22, &dut->io_diff_gpr_23,
+           &dut->io_diff_gpr_24, &dut->io_diff_gpr_25, &dut->io_diff_gpr_26, &dut->io_diff_gpr_27,
+           &dut->io_diff_gpr_28, &dut->io_diff_gpr_29, &dut->io_diff_gpr_30, &dut->io_diff_gpr_31 },
+    m_nr_batch(0), m_check_armed(false), m_check_pending(false), m_cycle(0), m_nr_history(0),
+    m_nr_checked(0), m_nr_skipped(0), m_nr_full_checks(0) {
+  if (!m_enable) {
+    return;
+  }
+  m_ref = new Interp(img, mem_size, reset_vector);
+  printf("[INFO] Difftest against the built-in RV64 model, batch = %d\n", DIFF_BATCH);
+}
+
+Difftest::~Difftest() {
+  if (m_ref != NULL) {
+    printf("[INFO] Difftest: %lu instructions checked, %lu skipped, %lu full state checks\n",
+           m_nr_checked, m_nr_skipped, m_nr_full_checks);
+    delete m_ref;
+  }
+}
+
+void Difftest::disable(const char *reason) {
+  printf("[WARN] Difftest disabled at cycle %lu: %s\n", m_cycle, reason);
+  m_enable = false;
+}
+
+bool Difftest::collect(uint64_t cycle) {
+  m_cycle = cycle;
+
+  //  The register file now holds everything retired up to the last cycle.
+  if (m_check_pending) {
+    m_check_pending = false;
+    if (!flush() || !check_state()) {
+      return false;
+    }
+  }
+
+  unsigned nr_commits = 0;
+  bool csr = false;
+  for (unsigned w = 0; w < SIM_RETIRE_WIDTH; w++) {
+    const RetirePorts &r = m_ports[w];
+    if (!*r.valid) {
+      continue;
+    }
+    DiffCommit &c = m_batch[m_nr_batch++];
+    c.pc = *r.pc;
+    c.wdata = *r.wdata;
+    c.rd = *r.rd;
+    c.wen = *r.wen && *r.rd != 0;
+    c.intr = false;
+    csr |= *r.csr;
+    nr_commits++;
+  }
+
+  //  A trapping instruction may show up on the retire ports later than the
+  //  trap, the check waits for the next retirement.
+  if (m_check_armed && nr_commits) {
+    m_check_armed = false;
+    m_check_pending = true;
+  }
+  if (m_dut->io_diff_xpt) {
+    m_check_armed = true;
+  }
+  if (m_dut->io_diff_intr) {
+    DiffCommit &c = m_batch[m_nr_batch++];
+    c.pc = m_dut->io_diff_cause;
+    c.intr = true;
+    m_check_pending = true;
+  }
+  m_check_pending |= csr;
+
+  if (m_nr_batch >= DIFF_BATCH) {
+    return flush();
+  }
+  return true;
+}
+
+bool Difftest::flush() {
+  unsigned n = m_nr_batch;
+  m_nr_batch = 0;
+  for (unsigned i = 0; i < n && m_enable; i++) {
+    const DiffCommit &c = m_batch[i];
+    if (c.intr) {
+      m_ref->raise_intr(c.pc);
+      continue;
+    }
+
+    RefStep s;
+    m_ref->step(s);
+    //  The DUT did not retire an instruction that raised an exception
+    if (!s.retired && ((s.pc ^ c.pc) & DIFF_PC_MASK)) {
+      m_ref->step(s);
+    }
+    if (s.unsupported) {
+      char reason[96];
+      snprintf(reason, sizeof(reason), "instruction 0x%08x at pc 0x%lx is not supported", s.inst, s.pc);
+      disable(reason);
+      return true;
+    }
+
+    History &h = m_history[m_nr_history++ % DIFF_HISTORY];
+    h.dut = c;
+    h.ref = s;
+    if ((s.pc ^ c.pc) & DIFF_PC_MASK) {
+      report("pc", c, s);
+      return false;
+    }
+    m_nr_checked++;
+    if (s.skip) {
+      m_nr_skipped++;
+      if (c.wen) {
+        m_ref->set_gpr(c.rd, c.wdata);
+      }
+      continue;
+    }
+    if (s.wen != c.wen || (c.wen && (s.rd != c.rd || s.wdata != c.wdata))) {
+      report("register write", c, s);
+      return false;
+    }
+  }
+  return true;
+}
+
+void Difftest::read_dut_state(ArchState &st) {
+  for (unsigned i = 0; i < DIFF_NR_GPRS; i++) {
+    st.gpr[i] = *m_gpr[i];
+  }
+  st.prv = m_dut->io_diff_prv;
+  st.mepc = m_dut->io_diff_mepc;
+  st.mcause = m_dut->io_diff_mcause;
+  st.sepc = m_dut->io_diff_sepc;
+  st.scause = m_dut->io_diff_scause;
+  st.satp = m_dut->io_diff_satp;
+  st.mstatus = m_dut->io_diff_mstatus;
+  st.mie = m_dut->io_diff_mie;
+  st.mip = m_dut->io_diff_mip;
+  st.mtvec = m_dut->io_diff_mtvec;
+  st.stvec = m_dut->io_diff_stvec;
+  st.mtval = m_dut->io_diff_mtval;
+  st.stval = m_dut->io_diff_stval;
+  st.mscratch = m_dut->io_diff_mscratch;
+  st.sscratch = m_dut->io_diff_sscratch;
+  st.medeleg = m_dut->io_diff_medeleg;
+  st.mideleg = m_dut->io_diff_mideleg;
+}
+
+bool Difftest::check_state() {
+  if (!m_enable) {
+    return true;
+  }
+  static const struct {
+    const char *name;
+    uint64_t ArchState::*field;
+    uint64_t mask;
+  } csrs[] = {
+    { "prv",      &ArchState::prv,      ~0UL },
+    { "mstatus",  &ArchState::mstatus,  DIFF_MSTATUS_MASK },
+    { "mepc",     &ArchState::mepc,     ~0UL },
+    { "mcause",   &ArchState::mcause,   ~0UL },
+    { "mtval",    &ArchState::mtval,    ~0UL },
+    { "mtvec",    &ArchState::mtvec,    ~0UL },
+    { "mscratch", &ArchState::mscratch, ~0UL },
+    { "medeleg",  &ArchState::medeleg,  ~0UL },
+    { "mideleg",  &ArchState::mideleg,  ~0UL },
+    { "mie",      &ArchState::mie,      ~0UL },
+    { "mip",      &ArchState::mip,      DIFF_MIP_MASK },
+    { "sepc",     &ArchState::sepc,     ~0UL },
+    { "scause",   &ArchState::scause,   ~0UL },
+    { "stval",    &ArchState::stval,    ~0UL },
+    { "stvec",    &ArchState::stvec,    ~0UL },
+    { "sscratch", &ArchState::sscratch, ~0UL },
+    { "satp",     &ArchState::satp,     ~0UL },
+  };
+
+  ArchState dut, ref;
+  read_dut_state(dut);
+  m_ref->get_state(ref);
+  m_nr_full_checks++;
+  if ((dut.satp >> 60) != 0) {
+    disable("address translation is on");
+    return true;
+  }
+
+  bool ok = true;
+  for (unsigned i = 1; i < DIFF_NR_GPRS; i++) {
+    if (dut.gpr[i] != ref.gpr[i]) {
+      if (ok) {
+        printf("[ERROR] Difftest: state mismatch at cycle %lu, %lu instructions checked\n", m_cycle, m_nr_checked);
+        ok = false;
+      }
+      printf("[ERROR]   x%-2u  dut 0x%016lx  ref 0x%016lx\n", i, dut.gpr[i], ref.gpr[i]);
+    }
+  }
+  for (const auto &csr : csrs) {
+    if ((dut.*csr.field ^ ref.*csr.field) & csr.mask) {
+      if (ok) {
+        printf("[ERROR] Difftest: state mismatch at cycle %lu, %lu instructions checked\n", m_cycle, m_nr_checked);
+        ok = false;
+      }
+      printf("[ERROR]   %-8s dut 0x%016lx  ref 0x%016lx\n", csr.name, dut.*csr.field, ref.*csr.field);
+    }
+  }
+  return ok;
+}
+
+bool Difftest::check_trap(uint64_t pc, uint64_t code) {
+  if (!m_enable) {
+    return true;
+  }
+  if (!flush()) {
+    return false;
+  }
+  if (!m_enable) {
+    return true;
+  }
+  ArchState ref;
+  m_ref->get_state(ref);
+  if (((m_ref->pc() ^ pc) & DIFF_PC_MASK) || ref.gpr[10] != code) {
+    printf("[ERROR] Difftest: trap at pc 0x%lx with a0 = 0x%lx, the model is at pc 0x%lx with a0 = 0x%lx\n",
+           pc, code, m_ref->pc(), ref.gpr[10]);
+    return false;
+  }
+  return true;
+}
+
+bool Difftest::finish() {
+  if (!m_enable) {
+    return true;
+  }
+  return flush();
+}
+
+void Difftest::report(const char *what, const DiffCommit &c, const RefStep &s) {
+  printf("[ERROR] Difftest: %s mismatch at cycle %lu, %lu instructions checked\n", what, m_cycle, m_nr_checked);
+  printf("[ERROR]   dut pc 0x%lx", c.pc);
+  if (c.wen) {
+    printf(", x%u = 0x%lx", c.rd, c.wdata);
+  }
+  printf("\n[ERROR]   ref pc 0x%lx, inst 0x%08x", s.pc, s.inst);
+  if (s.wen) {
+    printf(", x%u = 0x%lx", s.rd, s.wdata);
+  }
+  if (!s.retired) {
+    printf(", exception");
+  }
+  printf("\n[INFO] Last commits, oldest first:\n");
+  uint64_t first = m_nr_history > DIFF_HISTORY ? m_nr_history - DIFF_HISTORY : 0;
+  for (uint64_t i = first; i < m_nr_history; i++) {
+    const History &h = m_history[i % DIFF_HISTORY];
+    printf("[INFO]   0x%010lx  0x%08x", h.ref.pc, h.ref.inst);
+    if (h.dut.wen) {
+      printf("  x%-2u = 0x%016lx", h.dut.rd, h.dut.wdata);
+    }
+    printf("\n");
+  }
+}
@@ -0,0 +1,133 @@
+#ifndef __DIFFTEST_H__
+#define __DIFFTEST_H__
+
+#include <cstdint>
+
+#include "VSimTop.h"
+#include "sim_config.h"
+
+#define DIFF_NR_GPRS    32
+#define DIFF_BATCH      256   //  Commits buffered before they are replayed
+#define DIFF_HISTORY    16    //  Commits printed before a mismatch
+
+//  Architectural state compared on full checks.
+struct ArchState {
+  uint64_t gpr[DIFF_NR_GPRS];
+  uint64_t prv;
+  uint64_t mepc;
+  uint64_t mcause;
+  uint64_t sepc;
+  uint64_t scause;
+  uint64_t satp;
+  uint64_t mstatus;
+  uint64_t mie;
+  uint64_t mip;
+  uint64_t mtvec;
+  uint64_t stvec;
+  uint64_t mtval;
+  uint64_t stval;
+  uint64_t mscratch;
+  uint64_t sscratch;
+  uint64_t medeleg;
+  uint64_t mideleg;
+};
+
+//  One instruction executed by the reference model.
+struct RefStep {
+  uint64_t pc;
+  uint32_t inst;
+  bool retired;       //  false: it raised an exception instead
+  bool wen;
+  uint32_t rd;
+  uint64_t wdata;
+  bool skip;          //  Result comes from outside the model (MMIO, counters)
+  bool halt;          //  ebreak, the model stays at this pc
+  bool unsupported;   //  Valid on the DUT, not implemented by the model
+};
+
+class RefModel {
+public:
+  virtual ~RefModel() {}
+
+  virtual void step(RefStep &s) = 0;
+  virtual void raise_intr(uint64_t cause) = 0;
+  virtual uint64_t pc() const = 0;
+  virtual void set_gpr(unsigned i, uint64_t val) = 0;
+  virtual void get_state(ArchState &st) const = 0;
+};
+
+struct DiffCommit {
+  uint64_t pc;        //  Interrupt cause for interrupt entries
+  uint64_t wdata;
+  uint8_t rd;
+  bool wen;
+  bool intr;
+};
+
+//  Co-simulation against a reference model. Commits are buffered for
+//  DIFF_BATCH instructions and replayed in one go, each one checked for
+//  pc and register write. Full state checks (GPRs and the trap, interrupt
+//  and translation CSRs) only follow CSR instructions, traps and
+//  interrupts. The DUT register file lags the retire ports by one cycle,
+//  so those are done at the start of the next cycle. MMIO loads and
+//  counter reads are not compared, the model takes the DUT's value.
+class Difftest {
+public:
+  Difftest(VSimTop *dut, bool enable, const char *img, uint64_t mem_size, uint64_t reset_vector);
+  ~Difftest();
+
+  //  Called once per cycle, false on a mismatch.
+  inline bool step(uint64_t cycle) {
+    if (!m_enable) {
+      return true;
+    }
+    return collect(cycle);
+  }
+
+  //  The DUT hit ebreak: the model has to be there with the same a0.
+  bool check_trap(uint64_t pc, uint64_t code);
+  //  Replay what is still buffered, e.g. when a limit ends the run.
+  bool finish();
+
+private:
+  struct RetirePorts {
+    const CData *valid;
+    const QData *pc;
+    const CData *wen;
+    const CData *rd;
+    const QData *wdata;
+    const CData *csr;
+  };
+
+  VSimTop *m_dut;
+  RefModel *m_ref;
+  bool m_enable;
+  RetirePorts m_ports[SIM_RETIRE_WIDTH];
+  const QData *m_gpr[DIFF_NR_GPRS];
+
+  DiffCommit m_batch[DIFF_BATCH + SIM_RETIRE_WIDTH + 1];   //  + one cycle and an interrupt
+  unsigned m_nr_batch;
+  bool m_check_armed;             //  Trap seen, check after the next retirement
+  bool m_check_pending;           //  Check at the start of the next cycle
+  uint64_t m_cycle;
+
+  struct History {
+    DiffCommit dut;
+    RefStep ref;
+  };
+  History m_history[DIFF_HISTORY];
+  uint64_t m_nr_history;
+
+  uint64_t m_nr_checked;
+  uint64_t m_nr_skipped;
+  uint64_t m_nr_full_checks;
+
+  bool collect(uint64_t cycle);
+  bool flush();
+  bool check_state();
+  void read_dut_state(ArchState &st);
+  void disable(const char *reason);
+  void report(const char *what, const DiffCommit &c, const RefStep &s);
+};
+
+#endif
@@ -0,0 +1,352 @@
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <getopt.h>
+#include <verilated.h>
+
+#include "emu.h"
+#include "ram.h"
+#include "snapshot.h"
+#include "db.h"
+#include "evlog.h"
+#include "sim_config.h"
+
+#define RETIRE_VALID(w) + m_dut->io_retire_##w##_valid
+
+static bool assert_failed = false;
+
+//  Built with VL_USER_STOP/VL_USER_FATAL: an RTL assertion ends the run
+//  through the main loop, so the trace ring can still be flushed.
+void vl_stop(const char *filename, int linenum, const char *hier) {
+  printf("[ERROR] $stop at %s:%d\n", filename, linenum);
+  assert_failed = true;
+  Verilated::gotFinish(true);
+}
+
+void vl_fatal(const char *filename, int linenum, const char *hier, const char *msg) {
+  printf("[ERROR] $fatal at %s:%d: %s\n", filename, linenum, msg);
+  assert_failed = true;
+  Verilated::gotFinish(true);
+}
+
+static double host_seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+//  ********************************************
+//  Command line
+enum {
+  OPT_RESET_CYCLES = 256,
+  OPT_MAX_SECONDS,
+  OPT_STUCK_CYCLES,
+  OPT_TRACE_BEGIN,
+  OPT_TRACE_END,
+  OPT_TRACE_LOG,
+  OPT_TRACE_PC,
+  OPT_TRACE_PC_CYCLES,
+  OPT_TRACE_RING,
+  OPT_LOG_BEGIN,
+  OPT_LOG_END,
+  OPT_LOG_LEVEL,
+  OPT_LOG_FILE,
+  OPT_LOG_RING,
+  OPT_PMU,
+  OPT_PMU_INTERVAL,
+  OPT_DB,
+  OPT_DIFF,
+};
+
+static void usage(const char *prog) {
+  printf("Usage: %s [options] [image]\n", prog);
+  printf("  -i, --image FILE               bare-metal image (default: %s)\n", DEFAULT_IMAGE);
+  printf("  -b, --reset-vector ADDR        reset vector (default: 0)\n");
+  printf("      --reset-cycles N           cycles reset is held (default: 4)\n");
+  printf("  -C, --max-cycles N             stop after N cycles\n");
+  printf("  -I, --max-instrs N             stop after N retired instructions\n");
+  printf("  -W, --max-seconds N            stop after N seconds of host time\n");
+  printf("      --stuck-cycles N           fail after N cycles without a retirement (default: 5000, 0 disables)\n");
+  printf("  -s, --seed N                   seed for randomised reset values\n");
+  printf("  -r, --restore FILE             resume from a checkpoint\n");
+  printf("  -c, --checkpoint-interval N    save a checkpoint every N cycles\n");
+  printf("  -p, --checkpoint-prefix PATH   checkpoint file prefix (default: %s)\n", DEFAULT_CHECKPOINT_PREFIX);
+  printf("  -t, --trace FILE               dump an FST waveform to FILE\n");
+  printf("      --trace-begin N            trace from cycle N\n");
+  printf("      --trace-end N              trace until cycle N\n");
+  printf("      --trace-log                trace inside the log window\n");
+  printf("      --trace-pc PC              trace once PC retires\n");
+  printf("      --trace-pc-cycles N        cycles traced after a PC match (default: 1000)\n");
+  printf("      --trace-ring N             keep only the last N cycles, written on failure\n");
+  printf("      --log-begin N              log window begin cycle\n");
+  printf("      --log-end N                log window end cycle\n");
+  printf("      --log-level N              record events with level <= N (1 error .. 4 debug)\n");
+  printf("      --log-file FILE            binary event log, read it with evlog-reader\n");
+  printf("      --log-ring N               records kept in the event log (default: %lu)\n", EVLOG_DEFAULT_RING);
+  printf("      --pmu FILE                 write PMU event counts to FILE, read it with pmu-reader\n");
+  printf("      --pmu-interval N           cycles per PMU sample (default: 10000)\n");
+  printf("      --db FILE                  log ChiselDB tables to the SQLite file FILE\n");
+  printf("      --diff                     check every commit against the built-in RV64 model\n");
+  printf("  -h, --help                     print this message\n");
+  printf("Exit code: 0 good trap, 1 bad trap, 2 assertion, 3 stuck, 4 timeout, 5 difftest, 6 $finish, 7 limit reached\n");
+}
+
+EmuArgs parse_args(int argc, char **argv) {
+  EmuArgs args;
+  const struct option long_options[] = {
+    { "image",                required_argument, NULL, 'i' },
+    { "reset-vector",         required_argument, NULL, 'b' },
+    { "reset-cycles",         required_argument, NULL, OPT_RESET_CYCLES },
+    { "max-cycles",           required_argument, NULL, 'C' },
+    { "max-instrs",           required_argument, NULL, 'I' },
+    { "max-seconds",          required_argument, NULL, 'W' },
+    { "stuck-cycles",         required_argument, NULL, OPT_STUCK_CYCLES },
+    { "seed",                 required_argument, NULL, 's' },
+    { "restore",              required_argument, NULL, 'r' },
+    { "checkpoint-interval",  required_argument, NULL, 'c' },
+    { "checkpoint-prefix",    required_argument, NULL, 'p' },
+    { "trace",                required_argument, NULL, 't' },
+    { "trace-begin",          required_argument, NULL, OPT_TRACE_BEGIN },
+    { "trace-end",            required_argument, NULL, OPT_TRACE_END },
+    { "trace-log",            no_argument,       NULL, OPT_TRACE_LOG },
+    { "trace-pc",             required_argument, NULL, OPT_TRACE_PC },
+    { "trace-pc-cycles",      required_argument, NULL, OPT_TRACE_PC_CYCLES },
+    { "trace-ring",           required_argument, NULL, OPT_TRACE_RING },
+    { "log-begin",            required_argument, NULL, OPT_LOG_BEGIN },
+    { "log-end",              required_argument, NULL, OPT_LOG_END },
+    { "log-level",            required_argument, NULL, OPT_LOG_LEVEL },
+    { "log-file",             required_argument, NULL, OPT_LOG_FILE },
+    { "log-ring",             required_argument, NULL, OPT_LOG_RING },
+    { "pmu",                  required_argument, NULL, OPT_PMU },
+    { "pmu-interval",         required_argument, NULL, OPT_PMU_INTERVAL },
+    { "db",                   required_argument, NULL, OPT_DB },
+    { "diff",                 no_argument,       NULL, OPT_DIFF },
+    { "help",                 no_argument,       NULL, 'h' },
+    { 0,                      0,                 NULL,  0  }
+  };
+
+  int o;
+  while ((o = getopt_long(argc, argv, "i:b:C:I:W:s:r:c:p:t:h", long_options, NULL)) != -1) {
+    switch (o) {
+      case 'i': args.image = optarg; break;
+      case 'b': args.reset_vector = strtoull(optarg, NULL, 0); break;
+      case OPT_RESET_CYCLES: args.reset_cycles = strtoull(optarg, NULL, 0); break;
+      case 'C': args.max_cycles = strtoull(optarg, NULL, 0); break;
+      case 'I': args.max_instrs = strtoull(optarg, NULL, 0); break;
+      case 'W': args.max_seconds = strtoull(optarg, NULL, 0); break;
+      case OPT_STUCK_CYCLES: args.stuck_cycles = strtoull(optarg, NULL, 0); break;
+      case 's': args.has_seed = true; args.seed = strtoull(optarg, NULL, 0); break;
+      case 'r': args.restore = optarg; break;
+      case 'c': args.checkpoint_interval = strtoull(optarg, NULL, 0); break;
+      case 'p': args.checkpoint_prefix = optarg; break;
+      case 't': args.trace.file = optarg; break;
+      case OPT_TRACE_BEGIN: args.trace.begin = strtoull(optarg, NULL, 0); break;
+      case OPT_TRACE_END: args.trace.end = strtoull(optarg, NULL, 0); break;
+      case OPT_TRACE_LOG: args.trace.log_window = true; break;
+      case OPT_TRACE_PC: args.trace.pc_match = true; args.trace.pc = strtoull(optarg, NULL, 0); break;
+      case OPT_TRACE_PC_CYCLES: args.trace.pc_cycles = strtoull(optarg, NULL, 0); break;
+      case OPT_TRACE_RING: args.trace.ring_cycles = strtoull(optarg, NULL, 0); break;
+      case OPT_LOG_BEGIN: args.log_begin = strtoull(optarg, NULL, 0); break;
+      case OPT_LOG_END: args.log_end = strtoull(optarg, NULL, 0); break;
+      case OPT_LOG_LEVEL: args.log_level = strtoull(optarg, NULL, 0); break;
+      case OPT_LOG_FILE: args.log_file = optarg; break;
+      case OPT_LOG_RING: args.log_ring = strtoull(optarg, NULL, 0); break;
+      case OPT_PMU: args.pmu_file = optarg; break;
+      case OPT_PMU_INTERVAL: args.pmu_interval = strtoull(optarg, NULL, 0); break;
+      case OPT_DB: args.db_file = optarg; break;
+      case OPT_DIFF: args.difftest = true; break;
+      default:
+        usage(argv[0]);
+        exit(o == 'h' ? 0 : 1);
+    }
+  }
+  //  Positional image, plusargs are left to Verilator.
+  if (optind < argc && argv[optind][0] != '+') {
+    args.image = argv[optind];
+  }
+  args.trace.log_begin = args.log_begin;
+  args.trace.log_end = args.log_end;
+  return args;
+}
+
+//  ********************************************
+//  Emulator
+Emulator::Emulator(const EmuArgs &args)
+  : m_args(args), m_dut(NULL), m_tracer(NULL), m_pmu(NULL), m_difftest(NULL), m_sim_time(0), m_instrs(0),
+    m_last_commit(0), m_state(EMU_RUNNING), m_trap_pc(0), m_trap_code(0) {
+  if (m_args.has_seed) {
+    printf("[INFO] Using seed %lu\n", m_args.seed);
+    srand(m_args.seed);
+    srand48(m_args.seed);
+    //  Seeds Verilator's own generator behind X and random init values.
+    Verilated::randSeed(m_args.seed);
+    Verilated::randReset(2);
+  }
+
+  init_ram(m_args.image, RAM_SIZE);
+  init_db(m_args.db_file);
+  init_evlog(m_args.log_file, m_args.log_ring);
+  if (m_args.log_file == NULL && m_args.log_level && m_args.log_end > m_args.log_begin) {
+    printf("[WARN] Log window set without --log-file, events are dropped\n");
+  }
+  m_dut = new VSimTop();
+  if (m_args.restore != NULL) {
+    m_sim_time = restore_checkpoint(m_dut, m_args.restore, m_instrs);
+    m_last_commit = cycles();
+  }
+  m_tracer = new Tracer(m_dut, m_args.trace);
+  m_pmu = new PMUSampler(m_dut, m_args.pmu_file, m_args.pmu_interval, cycles());
+
+  //  The model starts from the image, not from a checkpoint.
+  if (m_args.difftest && m_args.restore != NULL) {
+    printf("[WARN] Difftest can not start from a checkpoint, it is disabled\n");
+    m_args.difftest = false;
+  }
+  m_difftest = new Difftest(m_dut, m_args.difftest, m_args.image, RAM_SIZE, m_args.reset_vector);
+}
+
+Emulator::~Emulator() {
+  delete m_difftest;
+  delete m_pmu;
+  delete m_tracer;
+  m_dut->final();
+  delete m_dut;
+  db_finish();
+  evlog_finish();
+  ram_finish();
+}
+
+void Emulator::tick() {
+  m_dut->clock = !m_dut->clock;
+  m_dut->reset = m_sim_time > 1 && m_sim_time < 2 * (m_args.reset_cycles + 1);
+  m_dut->eval();
+  m_tracer->dump(m_sim_time);
+  m_sim_time++;
+}
+
+void Emulator::single_cycle() {
+  m_dut->io_reset_vector = m_args.reset_vector;
+  m_dut->io_logCtrl_log_begin = m_args.log_begin;
+  m_dut->io_logCtrl_log_end = m_args.log_end;
+  m_dut->io_logCtrl_log_level = m_args.log_level;
+
+  tick();
+  tick();
+
+  unsigned nr_commits = 0 SIM_FOR_EACH_RETIRE(RETIRE_VALID);
+  if (nr_commits) {
+    m_instrs += nr_commits;
+    m_last_commit = cycles();
+  }
+  m_pmu->sample(cycles(), nr_commits);
+  if (cycles() > m_args.reset_cycles && !m_difftest->step(cycles())) {
+    m_state = EMU_DIFF;
+    return;
+  }
+  if (m_dut->io_trap_valid) {
+    m_trap_pc = m_dut->io_trap_pc;
+    m_trap_code = m_dut->io_trap_code;
+    m_state = m_trap_code == 0 ? EMU_GOOD_TRAP : EMU_BAD_TRAP;
+    if (!m_difftest->check_trap(m_trap_pc, m_trap_code)) {
+      m_state = EMU_DIFF;
+    }
+  }
+}
+
+void Emulator::check(double start) {
+  uint64_t cycle = cycles();
+  if (assert_failed) {
+    m_state = EMU_ASSERT;
+  } else if (Verilated::gotFinish()) {
+    m_state = EMU_FINISH;
+  } else if (m_args.stuck_cycles && cycle > m_args.reset_cycles &&
+             cycle - m_last_commit > m_args.stuck_cycles) {
+    m_state = EMU_STUCK;
+  } else if ((m_args.max_cycles && cycle >= m_args.max_cycles) ||
+             (m_args.max_instrs && m_instrs >= m_args.max_instrs)) {
+    m_state = EMU_LIMIT;
+  } else if (m_args.max_seconds && (cycle & 0x3ff) == 0 &&
+             host_seconds() - start >= m_args.max_seconds) {
+    m_state = EMU_TIMEOUT;
+  }
+}
+
+int Emulator::execute() {
+  double start = host_seconds();
+  uint64_t start_cycles = cycles();
+  uint64_t start_instrs = m_instrs;
+
+  while (m_state == EMU_RUNNING) {
+    single_cycle();
+    if (m_state != EMU_RUNNING) {
+      break;
+    }
+    check(start);
+
+    if (m_args.checkpoint_interval && cycles() % m_args.checkpoint_interval == 0) {
+      char filename[256];
+      snprintf(filename, sizeof(filename), "%s_%lu.gz", m_args.checkpoint_prefix, cycles());
+      save_checkpoint(m_dut, filename, m_sim_time, m_instrs);
+    }
+  }
+  if ((m_state == EMU_LIMIT || m_state == EMU_TIMEOUT) && !m_difftest->finish()) {
+    m_state = EMU_DIFF;
+  }
+  if (m_state == EMU_ASSERT) {
+    m_tracer->trigger("assertion", m_sim_time);
+  } else if (m_state == EMU_DIFF) {
+    m_tracer->trigger("difftest", m_sim_time);
+  }
+
+  double seconds = host_seconds() - start;
+  uint64_t run_cycles = cycles() - start_cycles;
+  uint64_t run_instrs = m_instrs - start_instrs;
+  report();
+  printf("[INFO] Host time: %.3f s, %.3f kHz, %.3f kIPS\n", seconds,
+         seconds > 0 ? run_cycles / seconds / 1000 : 0.0,
+         seconds > 0 ? run_instrs / seconds / 1000 : 0.0);
+
+  switch (m_state) {
+    case EMU_GOOD_TRAP: return 0;
+    case EMU_BAD_TRAP:  return 1;
+    case EMU_ASSERT:    return 2;
+    case EMU_STUCK:     return 3;
+    case EMU_DIFF:      return 5;
+    case EMU_FINISH:    return 6;
+    case EMU_LIMIT:     return 7;
+    default:            return 4;
+  }
+}
+
+void Emulator::report() {
+  switch (m_state) {
+    case EMU_GOOD_TRAP:
+      printf("[INFO] HIT GOOD TRAP at pc = 0x%lx\n", m_trap_pc);
+      break;
+    case EMU_BAD_TRAP:
+      printf("[ERROR] HIT BAD TRAP at pc = 0x%lx, code = %lu\n", m_trap_pc, m_trap_code);
+      break;
+    case EMU_ASSERT:
+      printf("[ERROR] Assertion failed at cycle %lu\n", cycles());
+      break;
+    case EMU_STUCK:
+      printf("[ERROR] No instruction retired for %lu cycles\n", m_args.stuck_cycles);
+      break;
+    case EMU_TIMEOUT:
+      printf("[INFO] Host time limit of %lu s reached\n", m_args.max_seconds);
+      break;
+    case EMU_LIMIT:
+      printf("[INFO] Cycle or instruction limit reached\n");
+      break;
+    case EMU_DIFF:
+      printf("[ERROR] Difftest mismatch at cycle %lu\n", cycles());
+      break;
+    case EMU_FINISH:
+      printf("[ERROR] $finish at cycle %lu\n", cycles());
+      break;
+    default:
+      break;
+  }
+  printf("[INFO] Cycles: %lu, Instructions: %lu, IPC: %.3f\n", cycles(), m_instrs,
+         cycles() ? (double)m_instrs / cycles() : 0.0);
+}
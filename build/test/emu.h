@@ -0,0 +1,98 @@
+#ifndef __EMU_H__
+#define __EMU_H__
+
+#include <cstdint>
+
+#include "VSimTop.h"
+#include "trace.h"
+#include "pmu.h"
+#include "evlog.h"
+#include "difftest.h"
+
+#define RAM_SIZE (1024UL * 1024 * 1024)
+#define DEFAULT_IMAGE "dummy-riscv64-nemu.bin"
+#define DEFAULT_CHECKPOINT_PREFIX "checkpoint"
+
+//  Why a run ended. Bare-metal images stop with ebreak, a0 = 0 is a good trap.
+enum EmuState {
+  EMU_RUNNING,
+  EMU_GOOD_TRAP,
+  EMU_BAD_TRAP,
+  EMU_ASSERT,
+  EMU_STUCK,
+  EMU_TIMEOUT,
+  EMU_LIMIT,
+  EMU_DIFF,
+  EMU_FINISH,
+};
+
+struct EmuArgs {
+  const char *image = DEFAULT_IMAGE;
+  uint64_t reset_vector = 0;
+  uint64_t reset_cycles = 4;
+
+  //  Limits, 0 means unlimited
+  uint64_t max_cycles = 0;
+  uint64_t max_instrs = 0;
+  uint64_t max_seconds = 0;        //  Host wall-clock
+  uint64_t stuck_cycles = 5000;    //  Cycles without a retired instruction
+
+  bool has_seed = false;
+  uint64_t seed = 0;
+
+  const char *restore = NULL;
+  uint64_t checkpoint_interval = 0;
+  const char *checkpoint_prefix = DEFAULT_CHECKPOINT_PREFIX;
+
+  //  Event log window [log_begin, log_end), events with level <= log_level
+  uint64_t log_begin = 0;
+  uint64_t log_end = 0;
+  uint64_t log_level = 0;
+  const char *log_file = NULL;
+  uint64_t log_ring = EVLOG_DEFAULT_RING;
+
+  TraceConfig trace;
+
+  const char *pmu_file = NULL;     //  PMU sample stream, NULL disables sampling
+  uint64_t pmu_interval = 10000;
+
+  const char *db_file = NULL;      //  ChiselDB SQLite file, NULL disables logging
+
+  bool difftest = false;           //  Check every commit against the built-in model
+};
+
+EmuArgs parse_args(int argc, char **argv);
+
+class Emulator {
+public:
+  Emulator(const EmuArgs &args);
+  ~Emulator();
+
+  //  Run until a trap or a limit, print the summary, return the exit code.
+  int execute();
+
+  uint64_t cycles() const { return m_sim_time / 2; }
+  uint64_t instrs() const { return m_instrs; }
+  EmuState state() const { return m_state; }
+
+private:
+  EmuArgs m_args;
+  VSimTop *m_dut;
+  Tracer *m_tracer;
+  PMUSampler *m_pmu;
+  Difftest *m_difftest;
+
+  uint64_t m_sim_time;
+  uint64_t m_instrs;
+  uint64_t m_last_commit;
+  EmuState m_state;
+  uint64_t m_trap_pc;
+  uint64_t m_trap_code;
+
+  void tick();
+  void single_cycle();
+  void check(double start);
+  void report();
+};
+
+#endif
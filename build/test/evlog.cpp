@@ -0,0 +1,78 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "evlog.h"
+
+static EvLogHeader *evlog_hdr = NULL;
+static EvLogRecord *evlog_ring = NULL;
+static uint64_t evlog_mask = 0;
+static size_t evlog_map_size = 0;
+
+void init_evlog(const char *file, uint64_t ring_size) {
+  if (file == NULL) {
+    return;
+  }
+  if (ring_size == 0 || (ring_size & (ring_size - 1))) {
+    printf("[ERROR] Event log ring size %lu is not a power of two\n", ring_size);
+    exit(1);
+  }
+
+  uint64_t data_offset = sizeof(EvLogHeader) + evlog_nr_events * sizeof(EvLogEvent);
+  data_offset = (data_offset + 4095) & ~4095UL;
+  evlog_map_size = data_offset + ring_size * sizeof(EvLogRecord);
+
+  int fd = open(file, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0 || ftruncate(fd, evlog_map_size) < 0) {
+    printf("[ERROR] Cannot create event log %s\n", file);
+    exit(1);
+  }
+  void *base = mmap(NULL, evlog_map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    printf("[ERROR] Cannot map event log %s\n", file);
+    exit(1);
+  }
+
+  evlog_hdr = (EvLogHeader *)base;
+  evlog_hdr->magic = EVLOG_MAGIC;
+  evlog_hdr->version = EVLOG_VERSION;
+  evlog_hdr->nr_events = evlog_nr_events;
+  evlog_hdr->ring_size = ring_size;
+  evlog_hdr->head = 0;
+  evlog_hdr->data_offset = data_offset;
+  memcpy(evlog_hdr + 1, evlog_events, evlog_nr_events * sizeof(EvLogEvent));
+
+  evlog_ring = (EvLogRecord *)((char *)base + data_offset);
+  evlog_mask = ring_size - 1;
+  printf("[INFO] Event log %s, %lu records\n", file, ring_size);
+}
+
+void evlog_finish() {
+  if (evlog_hdr == NULL) {
+    return;
+  }
+  printf("[INFO] Event log: %lu records\n", evlog_hdr->head);
+  munmap(evlog_hdr, evlog_map_size);
+  evlog_hdr = NULL;
+}
+
+//  Only reached inside the log window, the RTL gates the call.
+extern "C" void evlog_write(int event, uint64_t cycle, uint64_t a0, uint64_t a1, uint64_t a2, uint64_t a3) {
+  if (evlog_hdr == NULL) {
+    return;
+  }
+  uint64_t head = evlog_hdr->head;
+  EvLogRecord *rec = &evlog_ring[head & evlog_mask];
+  rec->cycle = cycle;
+  rec->event = event;
+  rec->reserved = 0;
+  rec->args[0] = a0;
+  rec->args[1] = a1;
+  rec->args[2] = a2;
+  rec->args[3] = a3;
+  evlog_hdr->head = head + 1;
+}
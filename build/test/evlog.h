@@ -0,0 +1,50 @@
+#ifndef __EVLOG_H__
+#define __EVLOG_H__
+
+#include <cstddef>
+#include <cstdint>
+
+//  Binary event log, written by zircon.utils.EventLog sites.
+//  File layout: EvLogHeader, the event table, then a ring of EvLogRecord
+//  starting at data_offset. The file is mapped shared, so it stays readable
+//  by evlog-reader even if the simulator dies.
+
+#define EVLOG_MAGIC     0x474c56455aULL   //  "ZEVLG"
+#define EVLOG_VERSION   1
+#define EVLOG_NR_ARGS   4
+#define EVLOG_DEFAULT_RING  (1UL << 20)   //  Records
+
+struct EvLogEvent {
+  char name[32];
+  char fmt[88];                 //  printf format taking uint64_t args
+  uint32_t level;
+  uint32_t nr_args;
+};
+
+struct EvLogHeader {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t nr_events;
+  uint64_t ring_size;           //  Records, power of two
+  uint64_t head;                //  Records written, the ring keeps the last ring_size
+  uint64_t data_offset;
+};
+
+struct EvLogRecord {
+  uint64_t cycle;
+  uint32_t event;
+  uint32_t reserved;
+  uint64_t args[EVLOG_NR_ARGS];
+};
+
+//  Event table, generated at elaboration into evlog_events.cpp
+extern const EvLogEvent evlog_events[];
+extern const int evlog_nr_events;
+
+//  NULL disables the log, evlog_write() then returns at once.
+void init_evlog(const char *file, uint64_t ring_size);
+void evlog_finish();
+
+extern "C" void evlog_write(int event, uint64_t cycle, uint64_t a0, uint64_t a1, uint64_t a2, uint64_t a3);
+
+#endif
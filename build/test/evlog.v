@@ -0,0 +1,34 @@
+import "DPI-C" function void evlog_write
+(
+  input  int        event_id,
+  input  longint    cycle,
+  input  longint    a0,
+  input  longint    a1,
+  input  longint    a2,
+  input  longint    a3
+);
+
+//  One instance per EventLog site, see zircon.utils.EventLog.
+//  en is already gated by the log window and level.
+module EventLogger #(
+  parameter EVENT = 0
+)(
+  input         clk,
+  input         en,
+  input  [63:0] args_0,
+  input  [63:0] args_1,
+  input  [63:0] args_2,
+  input  [63:0] args_3
+);
+
+  reg [63:0] cycle;
+  initial cycle = 0;
+
+  always @(posedge clk) begin
+    cycle <= cycle + 1;
+    if (en) begin
+      evlog_write(EVENT, cycle, args_0, args_1, args_2, args_3);
+    end
+  end
+
+endmodule
@@ -0,0 +1,12 @@
+//  Generated by EventLog, do not edit.
+
+#include "evlog.h"
+
+const EvLogEvent evlog_events[] = {
+  { "ITLB Refill", "addr 0x%lx, way %lu, set %lu, data 0x%lx", 3, 4 },
+  { "ICache Refill", "addr 0x%lx, way %lu, set %lu, data[63:0] 0x%lx", 3, 4 },
+  { "DTLB Refill", "addr 0x%lx, way %lu, set %lu, data 0x%lx", 3, 4 },
+  { "DCache Refill", "addr 0x%lx, way %lu, set %lu, data[63:0] 0x%lx", 3, 4 },
+  { "", "", 0, 0 }
+};
+const int evlog_nr_events = 4;
@@ -0,0 +1,130 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "evlog.h"
+
+//  Offline decoder for the log written by emu --log-file.
+//  Build: make evlog-reader
+
+static void usage(const char *prog) {
+  printf("Usage: %s [options] FILE\n", prog);
+  printf("  -e NAME     only events whose name contains NAME (repeatable)\n");
+  printf("  -b N        from cycle N\n");
+  printf("  -E N        until cycle N\n");
+  printf("  -l N        only events with level <= N\n");
+  printf("  -n N        only the last N matching records\n");
+  printf("  -s          print per-event counts instead of records\n");
+  printf("  -L          list the events the log knows about\n");
+}
+
+int main(int argc, char **argv) {
+  const char *names[16];
+  int nr_names = 0;
+  uint64_t begin = 0, end = UINT64_MAX, level = UINT32_MAX, last = 0;
+  bool summary = false, list = false;
+  int o;
+  while ((o = getopt(argc, argv, "e:b:E:l:n:sLh")) != -1) {
+    switch (o) {
+      case 'e':
+        if (nr_names < 16) {
+          names[nr_names++] = optarg;
+        }
+        break;
+      case 'b': begin = strtoull(optarg, NULL, 0); break;
+      case 'E': end = strtoull(optarg, NULL, 0); break;
+      case 'l': level = strtoull(optarg, NULL, 0); break;
+      case 'n': last = strtoull(optarg, NULL, 0); break;
+      case 's': summary = true; break;
+      case 'L': list = true; break;
+      default:
+        usage(argv[0]);
+        return o == 'h' ? 0 : 1;
+    }
+  }
+  if (optind >= argc) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  int fd = open(argv[optind], O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(EvLogHeader)) {
+    printf("[ERROR] Cannot open %s\n", argv[optind]);
+    return 1;
+  }
+  void *base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  const EvLogHeader *hdr = (const EvLogHeader *)base;
+  if (base == MAP_FAILED || hdr->magic != EVLOG_MAGIC || hdr->version != EVLOG_VERSION ||
+      hdr->data_offset + hdr->ring_size * sizeof(EvLogRecord) > (uint64_t)st.st_size) {
+    printf("[ERROR] %s is not an event log\n", argv[optind]);
+    return 1;
+  }
+  const EvLogEvent *events = (const EvLogEvent *)(hdr + 1);
+  const EvLogRecord *ring = (const EvLogRecord *)((const char *)base + hdr->data_offset);
+
+  if (list) {
+    for (uint32_t i = 0; i < hdr->nr_events; i++) {
+      printf("%3u  level %u  %-24s %s\n", i, events[i].level, events[i].name, events[i].fmt);
+    }
+    return 0;
+  }
+
+  //  Which events pass the name and level filters
+  bool *match = new bool[hdr->nr_events];
+  for (uint32_t i = 0; i < hdr->nr_events; i++) {
+    match[i] = events[i].level <= level;
+    if (match[i] && nr_names) {
+      match[i] = false;
+      for (int n = 0; n < nr_names; n++) {
+        match[i] |= strstr(events[i].name, names[n]) != NULL;
+      }
+    }
+  }
+
+  uint64_t head = hdr->head;
+  uint64_t first = head > hdr->ring_size ? head - hdr->ring_size : 0;
+  if (first) {
+    printf("[INFO] Ring wrapped, the first %lu records are lost\n", first);
+  }
+
+  //  Records are in cycle order, so -n is a backward scan.
+  uint64_t start = first;
+  if (last) {
+    uint64_t n = 0;
+    for (start = head; start > first && n < last; start--) {
+      const EvLogRecord &rec = ring[(start - 1) & (hdr->ring_size - 1)];
+      if (rec.event < hdr->nr_events && match[rec.event] && rec.cycle >= begin && rec.cycle < end) {
+        n++;
+      }
+    }
+  }
+
+  uint64_t *counts = new uint64_t[hdr->nr_events]();
+  for (uint64_t i = start; i < head; i++) {
+    const EvLogRecord &rec = ring[i & (hdr->ring_size - 1)];
+    if (rec.event >= hdr->nr_events || !match[rec.event] || rec.cycle < begin || rec.cycle >= end) {
+      continue;
+    }
+    counts[rec.event]++;
+    if (!summary) {
+      printf("[%10lu] %s: ", rec.cycle, events[rec.event].name);
+      printf(events[rec.event].fmt, rec.args[0], rec.args[1], rec.args[2], rec.args[3]);
+      printf("\n");
+    }
+  }
+
+  if (summary) {
+    for (uint32_t i = 0; i < hdr->nr_events; i++) {
+      if (counts[i]) {
+        printf("%-24s %12lu\n", events[i].name, counts[i]);
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,731 @@
+#include <cstdio>
+#include <cstring>
+
+#include "interp.h"
+#include "ram.h"
+
+#define PRV_U 0
+#define PRV_S 1
+#define PRV_M 3
+
+#define MSTATUS_SIE     (1UL << 1)
+#define MSTATUS_MIE     (1UL << 3)
+#define MSTATUS_SPIE    (1UL << 5)
+#define MSTATUS_MPIE    (1UL << 7)
+#define MSTATUS_SPP     (1UL << 8)
+#define MSTATUS_MPP     (3UL << 11)
+#define MSTATUS_FS      (3UL << 13)
+#define MSTATUS_MPRV    (1UL << 17)
+#define MSTATUS_SUM     (1UL << 18)
+#define MSTATUS_MXR     (1UL << 19)
+#define MSTATUS_TVM     (1UL << 20)
+#define MSTATUS_TW      (1UL << 21)
+#define MSTATUS_TSR     (1UL << 22)
+#define MSTATUS_UXL     (3UL << 32)
+#define MSTATUS_SXL     (3UL << 34)
+
+#define SSTATUS_WMASK   (MSTATUS_SIE | MSTATUS_SPIE | MSTATUS_SPP | MSTATUS_FS | MSTATUS_SUM | MSTATUS_MXR)
+#define MSTATUS_WMASK   (SSTATUS_WMASK | MSTATUS_MIE | MSTATUS_MPIE | MSTATUS_MPP | MSTATUS_MPRV | \
+                         MSTATUS_TVM | MSTATUS_TW | MSTATUS_TSR)
+
+#define CAUSE_ILLEGAL_INSTRUCTION 2
+#define CAUSE_MISALIGNED_LOAD     4
+#define CAUSE_MISALIGNED_STORE    6
+#define CAUSE_USER_ECALL          8
+#define CAUSE_INTERRUPT           (1UL << 63)
+
+//  Same set as custom_csr.scala
+#define MEDELEG_MASK    ((1UL << 0) | (1UL << 2) | (1UL << 3) | (1UL << 4) | (1UL << 6) | \
+                         (1UL << 8) | (1UL << 12) | (1UL << 13) | (1UL << 15))
+#define MIDELEG_MASK    0x222UL   //  SSIP, STIP, SEIP
+#define MIE_MASK        0xaaaUL
+
+//  SimTop address map: PLIC and the CLINT registers, everything else is RAM.
+#define PLIC_BASE       0x0c000000UL
+#define PLIC_SIZE       0x04000000UL
+
+static const uint64_t clint_regs[] = { 0x02000000, 0x02004000, 0x02004004, 0x0200bff8, 0x0200bffc };
+
+static bool is_mmio(uint64_t addr) {
+  if (addr - PLIC_BASE < PLIC_SIZE) {
+    return true;
+  }
+  for (uint64_t reg : clint_regs) {
+    if (addr == reg) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static inline uint32_t bits(uint32_t x, int hi, int lo) {
+  return (x >> lo) & ((1U << (hi - lo + 1)) - 1);
+}
+
+static inline int32_t sext(uint32_t x, int width) {
+  return (int32_t)(x << (32 - width)) >> (32 - width);
+}
+
+static inline uint64_t sext32(uint64_t x) {
+  return (uint64_t)(int64_t)(int32_t)x;
+}
+
+//  ********************************************
+//  RVC expansion
+static uint32_t enc_r(uint32_t f7, uint32_t rs2, uint32_t rs1, uint32_t f3, uint32_t rd, uint32_t op) {
+  return (f7 << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | op;
+}
+
+static uint32_t enc_i(int32_t imm, uint32_t rs1, uint32_t f3, uint32_t rd, uint32_t op) {
+  return ((imm & 0xfff) << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | op;
+}
+
+static uint32_t enc_s(int32_t imm, uint32_t rs2, uint32_t rs1, uint32_t f3, uint32_t op) {
+  return (((imm >> 5) & 0x7f) << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) | ((imm & 0x1f) << 7) | op;
+}
+
+static uint32_t enc_b(int32_t imm, uint32_t rs2, uint32_t rs1, uint32_t f3) {
+  return (((imm >> 12) & 1) << 31) | (((imm >> 5) & 0x3f) << 25) | (rs2 << 20) | (rs1 << 15) |
+         (f3 << 12) | (((imm >> 1) & 0xf) << 8) | (((imm >> 11) & 1) << 7) | 0x63;
+}
+
+static uint32_t enc_j(int32_t imm, uint32_t rd) {
+  return (((imm >> 20) & 1) << 31) | (((imm >> 1) & 0x3ff) << 21) | (((imm >> 11) & 1) << 20) |
+         (((imm >> 12) & 0xff) << 12) | (rd << 7) | 0x6f;
+}
+
+//  The equivalent 32-bit instruction, 0 if illegal.
+static uint32_t expand_rvc(uint32_t c) {
+  uint32_t rd = bits(c, 11, 7);
+  uint32_t rs2 = bits(c, 6, 2);
+  uint32_t rdp = 8 + bits(c, 4, 2);
+  uint32_t rs1p = 8 + bits(c, 9, 7);
+  int32_t imm6 = sext(bits(c, 12, 12) << 5 | bits(c, 6, 2), 6);
+  uint32_t shamt = bits(c, 12, 12) << 5 | bits(c, 6, 2);
+  uint32_t uimm_w = bits(c, 12, 10) << 3 | bits(c, 6, 6) << 2 | bits(c, 5, 5) << 6;
+  uint32_t uimm_d = bits(c, 12, 10) << 3 | bits(c, 6, 5) << 6;
+  int32_t imm;
+
+  switch ((bits(c, 1, 0) << 3) | bits(c, 15, 13)) {
+    //  Quadrant 0
+    case 000:   //  c.addi4spn
+      imm = bits(c, 12, 11) << 4 | bits(c, 10, 7) << 6 | bits(c, 6, 6) << 2 | bits(c, 5, 5) << 3;
+      return imm ? enc_i(imm, 2, 0, rdp, 0x13) : 0;
+    case 001: return enc_i(uimm_d, rs1p, 3, rdp, 0x07);         //  c.fld
+    case 002: return enc_i(uimm_w, rs1p, 2, rdp, 0x03);         //  c.lw
+    case 003: return enc_i(uimm_d, rs1p, 3, rdp, 0x03);         //  c.ld
+    case 005: return enc_s(uimm_d, rdp, rs1p, 3, 0x27);         //  c.fsd
+    case 006: return enc_s(uimm_w, rdp, rs1p, 2, 0x23);         //  c.sw
+    case 007: return enc_s(uimm_d, rdp, rs1p, 3, 0x23);         //  c.sd
+
+    //  Quadrant 1
+    case 010: return enc_i(imm6, rd, 0, rd, 0x13);              //  c.addi
+    case 011: return rd ? enc_i(imm6, rd, 0, rd, 0x1b) : 0;     //  c.addiw
+    case 012: return enc_i(imm6, 0, 0, rd, 0x13);               //  c.li
+    case 013:
+      if (rd == 2) {    //  c.addi16sp
+        imm = sext(bits(c, 12, 12) << 9 | bits(c, 6, 6) << 4 | bits(c, 5, 5) << 6 |
+                   bits(c, 4, 3) << 7 | bits(c, 2, 2) << 5, 10);
+        return imm ? enc_i(imm, 2, 0, 2, 0x13) : 0;
+      }
+      imm = sext(bits(c, 12, 12) << 17 | bits(c, 6, 2) << 12, 18);    //  c.lui
+      return imm ? (imm & 0xfffff000) | (rd << 7) | 0x37 : 0;
+    case 014:
+      switch (bits(c, 11, 10)) {
+        case 0: return enc_i(shamt, rs1p, 5, rs1p, 0x13);           //  c.srli
+        case 1: return enc_i(shamt | 0x400, rs1p, 5, rs1p, 0x13);   //  c.srai
+        case 2: return enc_i(imm6, rs1p, 7, rs1p, 0x13);            //  c.andi
+        default: {
+          static const uint32_t f3s[4] = { 0, 4, 6, 7 };            //  sub, xor, or, and
+          uint32_t f2 = bits(c, 6, 5);
+          if (!bits(c, 12, 12)) {
+            return enc_r(f2 ? 0 : 0x20, rdp, rs1p, f3s[f2], rs1p, 0x33);
+          }
+          return f2 < 2 ? enc_r(f2 ? 0 : 0x20, rdp, rs1p, 0, rs1p, 0x3b) : 0;   //  c.subw, c.addw
+        }
+      }
+    case 015:   //  c.j
+      imm = sext(bits(c, 12, 12) << 11 | bits(c, 11, 11) << 4 | bits(c, 10, 9) << 8 | bits(c, 8, 8) << 10 |
+                 bits(c, 7, 7) << 6 | bits(c, 6, 6) << 7 | bits(c, 5, 3) << 1 | bits(c, 2, 2) << 5, 12);
+      return enc_j(imm, 0);
+    case 016:   //  c.beqz
+    case 017:   //  c.bnez
+      imm = sext(bits(c, 12, 12) << 8 | bits(c, 11, 10) << 3 | bits(c, 6, 5) << 6 |
+                 bits(c, 4, 3) << 1 | bits(c, 2, 2) << 5, 9);
+      return enc_b(imm, 0, rs1p, bits(c, 13, 13));
+
+    //  Quadrant 2
+    case 020: return enc_i(shamt, rd, 1, rd, 0x13);             //  c.slli
+    case 021: return enc_i(bits(c, 12, 12) << 5 | bits(c, 6, 5) << 3 | bits(c, 4, 2) << 6, 2, 3, rd, 0x07);
+    case 022:   //  c.lwsp
+      return rd ? enc_i(bits(c, 12, 12) << 5 | bits(c, 6, 4) << 2 | bits(c, 3, 2) << 6, 2, 2, rd, 0x03) : 0;
+    case 023:   //  c.ldsp
+      return rd ? enc_i(bits(c, 12, 12) << 5 | bits(c, 6, 5) << 3 | bits(c, 4, 2) << 6, 2, 3, rd, 0x03) : 0;
+    case 024:
+      if (!bits(c, 12, 12)) {
+        if (rs2 == 0) {
+          return rd ? enc_i(0, rd, 0, 0, 0x67) : 0;             //  c.jr
+        }
+        return enc_r(0, rs2, 0, 0, rd, 0x33);                   //  c.mv
+      }
+      if (rs2 == 0) {
+        return rd ? enc_i(0, rd, 0, 1, 0x67) : 0x00100073;      //  c.jalr, c.ebreak
+      }
+      return enc_r(0, rs2, rd, 0, rd, 0x33);                    //  c.add
+    case 025: return enc_s(bits(c, 12, 10) << 3 | bits(c, 9, 7) << 6, rs2, 2, 3, 0x27);    //  c.fsdsp
+    case 026: return enc_s(bits(c, 12, 9) << 2 | bits(c, 8, 7) << 6, rs2, 2, 2, 0x23);     //  c.swsp
+    case 027: return enc_s(bits(c, 12, 10) << 3 | bits(c, 9, 7) << 6, rs2, 2, 3, 0x23);    //  c.sdsp
+    default:  return 0;
+  }
+}
+
+//  ********************************************
+//  Model
+Interp::Interp(const char *img, uint64_t mem_size, uint64_t reset_vector)
+  : m_mem_size(mem_size), m_halted(false), m_pc(reset_vector), m_prv(PRV_M),
+    m_reserved(false), m_reserve_addr(0),
+    m_mstatus(MSTATUS_MPP | (2UL << 32) | (2UL << 34)), m_medeleg(0), m_mideleg(0), m_mie(0), m_mip(0),
+    m_mtvec(0), m_mscratch(0), m_mepc(0), m_mcause(0), m_mtval(0), m_mcounteren(0),
+    m_stvec(0), m_sscratch(0), m_sepc(0), m_scause(0), m_stval(0), m_scounteren(0), m_satp(0) {
+  m_mem = map_ram(img, mem_size);
+  memset(m_gpr, 0, sizeof(m_gpr));
+}
+
+Interp::~Interp() {
+  unmap_ram(m_mem, m_mem_size);
+}
+
+void Interp::get_state(ArchState &st) const {
+  memcpy(st.gpr, m_gpr, sizeof(m_gpr));
+  st.prv = m_prv;
+  st.mepc = m_mepc;
+  st.mcause = m_mcause;
+  st.sepc = m_sepc;
+  st.scause = m_scause;
+  st.satp = m_satp;
+  st.mstatus = m_mstatus;
+  st.mie = m_mie;
+  st.mip = m_mip;
+  st.mtvec = m_mtvec;
+  st.stvec = m_stvec;
+  st.mtval = m_mtval;
+  st.stval = m_stval;
+  st.mscratch = m_mscratch;
+  st.sscratch = m_sscratch;
+  st.medeleg = m_medeleg;
+  st.mideleg = m_mideleg;
+}
+
+bool Interp::load(uint64_t addr, unsigned size, uint64_t &val) {
+  val = 0;
+  if (is_mmio(addr)) {
+    return false;
+  }
+  memcpy(&val, host(addr), size);
+  return true;
+}
+
+void Interp::store(uint64_t addr, unsigned size, uint64_t val) {
+  if (is_mmio(addr)) {
+    return;
+  }
+  memcpy(host(addr), &val, size);
+}
+
+void Interp::take_trap(uint64_t cause, uint64_t tval, uint64_t epc, uint64_t &npc) {
+  bool intr = cause & CAUSE_INTERRUPT;
+  uint64_t code = cause & ~CAUSE_INTERRUPT;
+  bool delegate = m_prv <= PRV_S && code < 64 && (((intr ? m_mideleg : m_medeleg) >> code) & 1);
+  uint64_t tvec;
+
+  if (delegate) {
+    m_sepc = epc;
+    m_scause = cause;
+    m_stval = tval;
+    m_mstatus = (m_mstatus & ~(MSTATUS_SPIE | MSTATUS_SIE | MSTATUS_SPP)) |
+                ((m_mstatus & MSTATUS_SIE) ? MSTATUS_SPIE : 0) | (m_prv ? MSTATUS_SPP : 0);
+    m_prv = PRV_S;
+    tvec = m_stvec;
+  } else {
+    m_mepc = epc;
+    m_mcause = cause;
+    m_mtval = tval;
+    m_mstatus = (m_mstatus & ~(MSTATUS_MPIE | MSTATUS_MIE | MSTATUS_MPP)) |
+                ((m_mstatus & MSTATUS_MIE) ? MSTATUS_MPIE : 0) | (m_prv << 11);
+    m_prv = PRV_M;
+    tvec = m_mtvec;
+  }
+  npc = (tvec & ~3UL) + ((tvec & 1) && intr ? 4 * code : 0);
+}
+
+void Interp::raise_intr(uint64_t cause) {
+  m_halted = false;
+  take_trap(cause | CAUSE_INTERRUPT, 0, m_pc, m_pc);
+}
+
+void Interp::illegal(RefStep &s, uint64_t &npc) {
+  take_trap(CAUSE_ILLEGAL_INSTRUCTION, s.inst, m_pc, npc);
+  s.retired = false;
+}
+
+//  Traps a misaligned access, false if it may go ahead.
+bool Interp::misaligned(uint64_t addr, unsigned size, uint64_t cause, RefStep &s, uint64_t &npc) {
+  if ((addr & (size - 1)) == 0) {
+    return false;
+  }
+  take_trap(cause, addr, m_pc, npc);
+  s.retired = false;
+  return true;
+}
+
+void Interp::step(RefStep &s) {
+  s.pc = m_pc;
+  s.inst = 0;
+  s.retired = true;
+  s.wen = false;
+  s.rd = 0;
+  s.wdata = 0;
+  s.skip = false;
+  s.halt = m_halted;
+  s.unsupported = false;
+  if (m_halted) {
+    return;
+  }
+  //  No page tables
+  if (m_prv != PRV_M && (m_satp >> 60) != 0) {
+    s.unsupported = true;
+    return;
+  }
+
+  uint16_t lo, hi;
+  memcpy(&lo, host(m_pc), 2);
+  if ((lo & 3) != 3) {
+    s.inst = lo;
+    exec(expand_rvc(lo), 2, s);
+  } else {
+    memcpy(&hi, host(m_pc + 2), 2);
+    s.inst = lo | (uint32_t)hi << 16;
+    exec(s.inst, 4, s);
+  }
+}
+
+void Interp::exec(uint32_t inst, unsigned len, RefStep &s) {
+  uint64_t npc = m_pc + len;
+  uint32_t rd = bits(inst, 11, 7);
+  uint32_t rs1 = bits(inst, 19, 15);
+  uint32_t rs2 = bits(inst, 24, 20);
+  uint32_t f3 = bits(inst, 14, 12);
+  uint32_t f7 = bits(inst, 31, 25);
+  uint64_t a = m_gpr[rs1];
+  uint64_t b = m_gpr[rs2];
+  int64_t imm_i = (int32_t)inst >> 20;
+  int64_t imm_s = (int32_t)(((int32_t)inst >> 25 << 5) | rd);
+  int64_t imm_b = (int32_t)(((int32_t)(inst & 0x80000000) >> 19) | ((inst & 0x80) << 4) |
+                            ((inst >> 20) & 0x7e0) | ((inst >> 7) & 0x1e));
+  int64_t imm_u = (int32_t)(inst & 0xfffff000);
+  int64_t imm_j = (int32_t)(((int32_t)(inst & 0x80000000) >> 11) | (inst & 0xff000) |
+                            ((inst >> 9) & 0x800) | ((inst >> 20) & 0x7fe));
+  bool wb = false;
+  bool bad = false;
+  uint64_t val = 0;
+
+  switch (inst & 0x7f) {
+    case 0x37:  //  LUI
+      val = imm_u;
+      wb = true;
+      break;
+    case 0x17:  //  AUIPC
+      val = m_pc + imm_u;
+      wb = true;
+      break;
+    case 0x6f:  //  JAL
+      val = npc;
+      npc = m_pc + imm_j;
+      wb = true;
+      break;
+    case 0x67:  //  JALR
+      bad = f3 != 0;
+      val = npc;
+      npc = (a + imm_i) & ~1UL;
+      wb = true;
+      break;
+    case 0x63: {
+      bool taken = false;
+      switch (f3) {
+        case 0: taken = a == b; break;
+        case 1: taken = a != b; break;
+        case 4: taken = (int64_t)a < (int64_t)b; break;
+        case 5: taken = (int64_t)a >= (int64_t)b; break;
+        case 6: taken = a < b; break;
+        case 7: taken = a >= b; break;
+        default: bad = true; break;
+      }
+      if (taken) {
+        npc = m_pc + imm_b;
+      }
+      break;
+    }
+    case 0x03: {
+      unsigned size = 1 << (f3 & 3);
+      if (f3 == 7) {
+        bad = true;
+        break;
+      }
+      if (INTERP_MISALIGNED_TRAP && misaligned(a + imm_i, size, CAUSE_MISALIGNED_LOAD, s, npc)) {
+        break;
+      }
+      if (!load(a + imm_i, size, val)) {
+        s.skip = true;
+      }
+      if (f3 < 4 && size < 8) {
+        val = (uint64_t)((int64_t)(val << (64 - 8 * size)) >> (64 - 8 * size));
+      }
+      wb = true;
+      break;
+    }
+    case 0x23:
+      if (f3 > 3) {
+        bad = true;
+        break;
+      }
+      if (INTERP_MISALIGNED_TRAP && misaligned(a + imm_s, 1 << f3, CAUSE_MISALIGNED_STORE, s, npc)) {
+        break;
+      }
+      store(a + imm_s, 1 << f3, b);
+      break;
+    case 0x13: {
+      unsigned shamt = bits(inst, 25, 20);
+      switch (f3) {
+        case 0: val = a + imm_i; break;
+        case 1: val = a << shamt; bad = bits(inst, 31, 26) != 0; break;
+        case 2: val = (int64_t)a < imm_i; break;
+        case 3: val = a < (uint64_t)imm_i; break;
+        case 4: val = a ^ imm_i; break;
+        case 5:
+          if (bits(inst, 31, 26) == 0) {
+            val = a >> shamt;
+          } else if (bits(inst, 31, 26) == 0x10) {
+            val = (int64_t)a >> shamt;
+          } else {
+            bad = true;
+          }
+          break;
+        case 6: val = a | imm_i; break;
+        case 7: val = a & imm_i; break;
+      }
+      wb = true;
+      break;
+    }
+    case 0x1b: {
+      unsigned shamt = bits(inst, 24, 20);
+      if (f3 == 0) {
+        val = sext32(a + imm_i);
+      } else if (f3 == 1 && f7 == 0) {
+        val = sext32(a << shamt);
+      } else if (f3 == 5 && f7 == 0) {
+        val = sext32((uint32_t)a >> shamt);
+      } else if (f3 == 5 && f7 == 0x20) {
+        val = sext32((int32_t)a >> shamt);
+      } else {
+        bad = true;
+      }
+      wb = true;
+      break;
+    }
+    case 0x33:
+      if (f7 == 1) {
+        switch (f3) {
+          case 0: val = a * b; break;
+          case 1: val = ((__int128)(int64_t)a * (int64_t)b) >> 64; break;
+          case 2: val = ((__int128)(int64_t)a * (__int128)b) >> 64; break;
+          case 3: val = ((unsigned __int128)a * b) >> 64; break;
+          case 4:
+            val = b == 0 ? ~0UL : ((int64_t)a == INT64_MIN && (int64_t)b == -1) ? a : (int64_t)a / (int64_t)b;
+            break;
+          case 5: val = b == 0 ? ~0UL : a / b; break;
+          case 6:
+            val = b == 0 ? a : ((int64_t)a == INT64_MIN && (int64_t)b == -1) ? 0 : (int64_t)a % (int64_t)b;
+            break;
+          case 7: val = b == 0 ? a : a % b; break;
+        }
+      } else if (f7 == 0) {
+        switch (f3) {
+          case 0: val = a + b; break;
+          case 1: val = a << (b & 63); break;
+          case 2: val = (int64_t)a < (int64_t)b; break;
+          case 3: val = a < b; break;
+          case 4: val = a ^ b; break;
+          case 5: val = a >> (b & 63); break;
+          case 6: val = a | b; break;
+          case 7: val = a & b; break;
+        }
+      } else if (f7 == 0x20 && f3 == 0) {
+        val = a - b;
+      } else if (f7 == 0x20 && f3 == 5) {
+        val = (int64_t)a >> (b & 63);
+      } else {
+        bad = true;
+      }
+      wb = true;
+      break;
+    case 0x3b: {
+      int32_t sa = a, sb = b;
+      uint32_t ua = a, ub = b;
+      if (f7 == 1) {
+        switch (f3) {
+          case 0: val = sext32(ua * ub); break;
+          case 4: val = sext32(sb == 0 ? ~0U : (sa == INT32_MIN && sb == -1) ? sa : sa / sb); break;
+          case 5: val = sext32(ub == 0 ? ~0U : ua / ub); break;
+          case 6: val = sext32(sb == 0 ? sa : (sa == INT32_MIN && sb == -1) ? 0 : sa % sb); break;
+          case 7: val = sext32(ub == 0 ? ua : ua % ub); break;
+          default: bad = true; break;
+        }
+      } else if (f7 == 0 && f3 == 0) {
+        val = sext32(ua + ub);
+      } else if (f7 == 0 && f3 == 1) {
+        val = sext32(ua << (ub & 31));
+      } else if (f7 == 0 && f3 == 5) {
+        val = sext32(ua >> (ub & 31));
+      } else if (f7 == 0x20 && f3 == 0) {
+        val = sext32(ua - ub);
+      } else if (f7 == 0x20 && f3 == 5) {
+        val = sext32(sa >> (ub & 31));
+      } else {
+        bad = true;
+      }
+      wb = true;
+      break;
+    }
+    case 0x0f:  //  FENCE, FENCE.I
+      bad = f3 > 1;
+      break;
+    case 0x73:
+      wb = exec_system(inst, s, npc, val);
+      break;
+    case 0x2f:
+      wb = exec_amo(inst, s, npc, val);
+      break;
+    case 0x07: case 0x27: case 0x43: case 0x47: case 0x4b: case 0x4f: case 0x53:
+      s.unsupported = true;
+      return;
+    default:
+      bad = true;
+      break;
+  }
+
+  if (bad) {
+    illegal(s, npc);
+  } else if (wb && s.retired) {
+    if (rd) {
+      m_gpr[rd] = val;
+    }
+    s.wen = rd != 0;
+    s.rd = rd;
+    s.wdata = val;
+  }
+  m_pc = npc;
+}
+
+bool Interp::exec_system(uint32_t inst, RefStep &s, uint64_t &npc, uint64_t &val) {
+  uint32_t rd = bits(inst, 11, 7);
+  uint32_t rs1 = bits(inst, 19, 15);
+  uint32_t f3 = bits(inst, 14, 12);
+  unsigned csr = inst >> 20;
+
+  if (f3 == 0) {
+    if (inst == 0x00000073) {           //  ecall
+      take_trap(CAUSE_USER_ECALL + m_prv, 0, m_pc, npc);
+      s.retired = false;
+    } else if (inst == 0x00100073) {    //  ebreak
+      m_halted = true;
+      s.halt = true;
+      npc = m_pc;
+    } else if (inst == 0x30200073 && m_prv == PRV_M) {   //  mret
+      uint64_t mpp = (m_mstatus & MSTATUS_MPP) >> 11;
+      m_mstatus = (m_mstatus & ~(MSTATUS_MIE | MSTATUS_MPP)) | MSTATUS_MPIE |
+                  ((m_mstatus & MSTATUS_MPIE) ? MSTATUS_MIE : 0);
+      m_prv = mpp;
+      npc = m_mepc;
+    } else if (inst == 0x10200073 && (m_prv == PRV_M || (m_prv == PRV_S && !(m_mstatus & MSTATUS_TSR)))) {
+      uint64_t spp = (m_mstatus & MSTATUS_SPP) ? PRV_S : PRV_U;   //  sret
+      m_mstatus = (m_mstatus & ~(MSTATUS_SIE | MSTATUS_SPP)) | MSTATUS_SPIE |
+                  ((m_mstatus & MSTATUS_SPIE) ? MSTATUS_SIE : 0);
+      m_prv = spp;
+      npc = m_sepc;
+    } else if (inst == 0x10500073) {    //  wfi, interrupts come from the DUT
+    } else if ((inst >> 25) == 0x09 && rd == 0 &&
+               (m_prv == PRV_M || (m_prv == PRV_S && !(m_mstatus & MSTATUS_TVM)))) {
+      //  sfence.vma
+    } else {
+      illegal(s, npc);
+    }
+    return false;
+  }
+
+  if (f3 == 4 || !csr_read(csr, val, s)) {
+    illegal(s, npc);
+    return false;
+  }
+  uint64_t src = (f3 & 4) ? rs1 : m_gpr[rs1];
+  if ((f3 & 3) == 1 || rs1 != 0) {
+    uint64_t wdata = (f3 & 3) == 1 ? src : (f3 & 3) == 2 ? (val | src) : (val & ~src);
+    if ((csr >> 10) == 3 || !csr_write(csr, wdata)) {
+      illegal(s, npc);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Interp::exec_amo(uint32_t inst, RefStep &s, uint64_t &npc, uint64_t &val) {
+  uint32_t f3 = bits(inst, 14, 12);
+  uint32_t f5 = bits(inst, 31, 27);
+  uint64_t addr = m_gpr[bits(inst, 19, 15)];
+  uint64_t b = m_gpr[bits(inst, 24, 20)];
+  unsigned size = f3 == 2 ? 4 : 8;
+  uint64_t old;
+
+  if (f3 != 2 && f3 != 3) {
+    illegal(s, npc);
+    return false;
+  }
+  //  AMOs must be aligned whatever the LSU does for plain accesses.
+  if (misaligned(addr, size, f5 == 0x02 ? CAUSE_MISALIGNED_LOAD : CAUSE_MISALIGNED_STORE, s, npc)) {
+    return false;
+  }
+  if (f5 == 0x02) {         //  lr
+    if (bits(inst, 24, 20) != 0) {
+      illegal(s, npc);
+      return false;
+    }
+    s.skip = !load(addr, size, old);
+    m_reserved = true;
+    m_reserve_addr = addr;
+    val = size == 4 ? sext32(old) : old;
+    return true;
+  }
+  if (f5 == 0x03) {         //  sc
+    val = !(m_reserved && m_reserve_addr == addr);
+    if (!val) {
+      store(addr, size, b);
+    }
+    m_reserved = false;
+    return true;
+  }
+
+  if (!load(addr, size, old)) {
+    s.skip = true;
+    return true;
+  }
+  if (size == 4) {
+    old = sext32(old);
+    b = sext32(b);
+  }
+  uint64_t wdata;
+  uint64_t mask = size == 4 ? 0xffffffffUL : ~0UL;
+  switch (f5) {
+    case 0x01: wdata = b; break;
+    case 0x00: wdata = old + b; break;
+    case 0x04: wdata = old ^ b; break;
+    case 0x0c: wdata = old & b; break;
+    case 0x08: wdata = old | b; break;
+    case 0x10: wdata = (int64_t)old < (int64_t)b ? old : b; break;
+    case 0x14: wdata = (int64_t)old > (int64_t)b ? old : b; break;
+    case 0x18: wdata = (old & mask) < (b & mask) ? old : b; break;
+    case 0x1c: wdata = (old & mask) > (b & mask) ? old : b; break;
+    default:
+      illegal(s, npc);
+      return false;
+  }
+  store(addr, size, wdata);
+  val = old;
+  return true;
+}
+
+//  CSRs whose value the model does not own (counters, mip, WARL fields of
+//  mstatus/misa, PMP) are read as skip: the driver takes the DUT's result.
+bool Interp::csr_read(unsigned addr, uint64_t &val, RefStep &s) {
+  if (((addr >> 8) & 3) > m_prv) {
+    return false;
+  }
+  val = 0;
+  switch (addr) {
+    case 0x001: case 0x002: case 0x003:     //  fflags, frm, fcsr
+      s.unsupported = true;
+      break;
+    case 0x100: val = m_mstatus & (SSTATUS_WMASK | MSTATUS_UXL); s.skip = true; break;
+    case 0x104: val = m_mie & m_mideleg; break;
+    case 0x105: val = m_stvec; break;
+    case 0x106: val = m_scounteren; break;
+    case 0x140: val = m_sscratch; break;
+    case 0x141: val = m_sepc; break;
+    case 0x142: val = m_scause; break;
+    case 0x143: val = m_stval; break;
+    case 0x144: val = m_mip & m_mideleg; s.skip = true; break;
+    case 0x180:
+      if (m_prv == PRV_S && (m_mstatus & MSTATUS_TVM)) {
+        return false;
+      }
+      val = m_satp;
+      break;
+    case 0x300: val = m_mstatus; s.skip = true; break;
+    case 0x302: val = m_medeleg; break;
+    case 0x303: val = m_mideleg; break;
+    case 0x304: val = m_mie; break;
+    case 0x305: val = m_mtvec; break;
+    case 0x306: val = m_mcounteren; break;
+    case 0x340: val = m_mscratch; break;
+    case 0x341: val = m_mepc; break;
+    case 0x342: val = m_mcause; break;
+    case 0x343: val = m_mtval; break;
+    case 0x344: val = m_mip; s.skip = true; break;
+    case 0xf11: case 0xf12: case 0xf13: case 0xf14:
+      break;
+    default:    //  misa, counters, hpm events, PMP
+      s.skip = true;
+      break;
+  }
+  return true;
+}
+
+bool Interp::csr_write(unsigned addr, uint64_t val) {
+  switch (addr) {
+    case 0x100: m_mstatus = (m_mstatus & ~SSTATUS_WMASK) | (val & SSTATUS_WMASK); break;
+    case 0x104: m_mie = (m_mie & ~m_mideleg) | (val & m_mideleg & MIE_MASK); break;
+    case 0x105: m_stvec = val; break;
+    case 0x106: m_scounteren = val & 0xffffffffUL; break;
+    case 0x140: m_sscratch = val; break;
+    case 0x141: m_sepc = val & ~1UL; break;
+    case 0x142: m_scause = val; break;
+    case 0x143: m_stval = val; break;
+    case 0x144: m_mip = (m_mip & ~(m_mideleg & 0x2UL)) | (val & m_mideleg & 0x2UL); break;
+    case 0x180:
+      if (m_prv == PRV_S && (m_mstatus & MSTATUS_TVM)) {
+        return false;
+      }
+      if ((val >> 60) == 0 || (val >> 60) == 8) {
+        m_satp = val;
+      }
+      break;
+    case 0x300:
+      //  MPP is WARL, 2 is reserved
+      if (((val & MSTATUS_MPP) >> 11) == 2) {
+        val = (val & ~MSTATUS_MPP) | (m_mstatus & MSTATUS_MPP);
+      }
+      m_mstatus = (m_mstatus & ~MSTATUS_WMASK) | (val & MSTATUS_WMASK);
+      break;
+    case 0x302: m_medeleg = val & MEDELEG_MASK; break;
+    case 0x303: m_mideleg = val & MIDELEG_MASK; break;
+    case 0x304: m_mie = val & MIE_MASK; break;
+    case 0x305: m_mtvec = val; break;
+    case 0x306: m_mcounteren = val & 0xffffffffUL; break;
+    case 0x340: m_mscratch = val; break;
+    case 0x341: m_mepc = val & ~1UL; break;
+    case 0x342: m_mcause = val; break;
+    case 0x343: m_mtval = val; break;
+    case 0x344: m_mip = (m_mip & ~MIDELEG_MASK) | (val & MIDELEG_MASK); break;
+    default:    //  Counters and the rest are not modelled
+      break;
+  }
+  return true;
+}
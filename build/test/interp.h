@@ -0,0 +1,76 @@
+#ifndef __INTERP_H__
+#define __INTERP_H__
+
+#include <cstdint>
+
+#include "difftest.h"
+
+//  Misaligned loads and stores raise address-misaligned exceptions, as the
+//  DUT does. Build with 0 to perform them instead.
+#ifndef INTERP_MISALIGNED_TRAP
+#define INTERP_MISALIGNED_TRAP 1
+#endif
+
+//  Built-in RV64IMAC_Zicsr_Zifencei reference model with M/S/U modes and
+//  bare addressing. It has its own copy of the image and the same aliasing
+//  RAM as SimTop; PLIC and CLINT accesses are not modelled, loads from them
+//  are marked skip and stores are dropped. ebreak halts the model.
+class Interp : public RefModel {
+public:
+  Interp(const char *img, uint64_t mem_size, uint64_t reset_vector);
+  ~Interp();
+
+  void step(RefStep &s) override;
+  void raise_intr(uint64_t cause) override;
+  uint64_t pc() const override { return m_pc; }
+  void set_gpr(unsigned i, uint64_t val) override { if (i) m_gpr[i] = val; }
+  void get_state(ArchState &st) const override;
+
+private:
+  uint8_t *m_mem;
+  uint64_t m_mem_size;
+  bool m_halted;
+
+  uint64_t m_gpr[DIFF_NR_GPRS];
+  uint64_t m_pc;
+  uint64_t m_prv;
+
+  //  LR/SC
+  bool m_reserved;
+  uint64_t m_reserve_addr;
+
+  //  CSRs
+  uint64_t m_mstatus;
+  uint64_t m_medeleg;
+  uint64_t m_mideleg;
+  uint64_t m_mie;
+  uint64_t m_mip;
+  uint64_t m_mtvec;
+  uint64_t m_mscratch;
+  uint64_t m_mepc;
+  uint64_t m_mcause;
+  uint64_t m_mtval;
+  uint64_t m_mcounteren;
+  uint64_t m_stvec;
+  uint64_t m_sscratch;
+  uint64_t m_sepc;
+  uint64_t m_scause;
+  uint64_t m_stval;
+  uint64_t m_scounteren;
+  uint64_t m_satp;
+
+  void exec(uint32_t inst, unsigned len, RefStep &s);
+  bool exec_system(uint32_t inst, RefStep &s, uint64_t &npc, uint64_t &val);
+  bool exec_amo(uint32_t inst, RefStep &s, uint64_t &npc, uint64_t &val);
+  void illegal(RefStep &s, uint64_t &npc);
+  bool misaligned(uint64_t addr, unsigned size, uint64_t cause, RefStep &s, uint64_t &npc);
+  bool csr_read(unsigned addr, uint64_t &val, RefStep &s);
+  bool csr_write(unsigned addr, uint64_t val);
+  void take_trap(uint64_t cause, uint64_t tval, uint64_t epc, uint64_t &npc);
+
+  bool load(uint64_t addr, unsigned size, uint64_t &val);
+  void store(uint64_t addr, unsigned size, uint64_t val);
+  uint8_t *host(uint64_t addr) { return m_mem + (addr & (m_mem_size - 1)); }
+};
+
+#endif
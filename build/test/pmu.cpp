@@ -0,0 +1,69 @@
+#include <cstring>
+
+#include "pmu.h"
+#include "VSimTop.h"
+#include "sim_config.h"
+
+#define PMU_BUF_SIZE      (1 << 20)
+
+PMUSampler::PMUSampler(VSimTop *dut, const char *file, uint64_t interval, uint64_t start_cycle)
+  : m_dut(dut), m_file(NULL), m_interval(interval) {
+  memset(&m_rec, 0, sizeof(m_rec));
+  m_rec.cycle = start_cycle;
+  if (file == NULL || interval == 0) {
+    return;
+  }
+  m_file = fopen(file, "wb");
+  if (m_file == NULL) {
+    printf("[ERROR] Cannot open PMU file %s\n", file);
+    return;
+  }
+  setvbuf(m_file, NULL, _IOFBF, PMU_BUF_SIZE);
+
+  PMUHeader hdr;
+  hdr.magic = PMU_MAGIC;
+  hdr.version = PMU_VERSION;
+  hdr.nr_counters = PMU_NR_COUNTERS;
+  hdr.width = SIM_RETIRE_WIDTH;
+  hdr.interval = interval;
+  fwrite(&hdr, sizeof(hdr), 1, m_file);
+  printf("[INFO] Sampling PMU every %lu cycles to %s\n", interval, file);
+}
+
+PMUSampler::~PMUSampler() {
+  if (m_file == NULL) {
+    return;
+  }
+  //  Partial last interval, m_rec.cycle still holds its start
+  if (m_rec.cycles) {
+    flush(m_rec.cycle + m_rec.cycles);
+  }
+  fclose(m_file);
+}
+
+void PMUSampler::accumulate(unsigned nr_commits) {
+  m_rec.instrs += nr_commits;
+
+  //  Most cycles raise nothing but a cache access or two.
+  //  MDU and FPU count every retiring op, like mhpmcounter.
+  uint32_t events = m_dut->io_pmu_events & ~(1U << PMU_MDU | 1U << PMU_FPU);
+  while (events) {
+    m_rec.counters[__builtin_ctz(events)]++;
+    events &= events - 1;
+  }
+  m_rec.counters[PMU_MDU] += m_dut->io_pmu_mdus;
+  m_rec.counters[PMU_FPU] += m_dut->io_pmu_fpus;
+
+  uint32_t topdown = m_dut->io_pmu_topdown;
+  while (topdown) {
+    m_rec.counters[PMU_TD_FRONTEND + __builtin_ctz(topdown)]++;
+    topdown &= topdown - 1;
+  }
+}
+
+void PMUSampler::flush(uint64_t cycle) {
+  m_rec.cycle = cycle;
+  fwrite(&m_rec, sizeof(m_rec), 1, m_file);
+  memset(&m_rec, 0, sizeof(m_rec));
+  m_rec.cycle = cycle;
+}
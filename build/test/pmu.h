@@ -0,0 +1,104 @@
+#ifndef __PMU_H__
+#define __PMU_H__
+
+#include <cstdio>
+#include <cstdint>
+
+//  PMU sample stream, shared by the sampler and pmu-reader.
+//  File layout: PMUHeader, then one PMURecord per interval.
+//  Counter 0..26 follow the order of imp_mhpevts in custom_csr.scala.
+enum {
+  PMU_NONE,
+  PMU_MISPRED,
+  PMU_EXCEPTION,
+  PMU_INTERRUPT,
+  PMU_CSR,
+  PMU_JMP,
+  PMU_BR,
+  PMU_RET_EBREAK,
+  PMU_RET_ECALL,
+  PMU_MDU,
+  PMU_FPU,
+  PMU_ICACHE_ACCESS,
+  PMU_ICACHE_MISS,
+  PMU_ITLB_ACCESS,
+  PMU_ITLB_MISS,
+  PMU_DCACHE_READ_ACCESS,
+  PMU_DCACHE_WRITE_ACCESS,
+  PMU_DCACHE_ATOM_ACCESS,
+  PMU_DCACHE_READ_MISS,
+  PMU_DCACHE_WRITE_MISS,
+  PMU_DCACHE_ATOM_MISS,
+  PMU_DTLB_ACCESS,
+  PMU_DTLB_MISS,
+  PMU_STALL,
+  PMU_FLUSH,
+  PMU_ECALL,
+  PMU_EBREAK,
+  PMU_NR_EVENTS,
+
+  //  Top-down, one per cycle without retirement
+  PMU_TD_FRONTEND = PMU_NR_EVENTS,
+  PMU_TD_MEMORY,
+  PMU_TD_CORE,
+  PMU_TD_BAD_SPEC,
+  PMU_NR_COUNTERS
+};
+
+#define PMU_MAGIC   0x554d505aU   //  "ZPMU"
+#define PMU_VERSION 2
+
+struct PMUHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t nr_counters;
+  uint32_t width;           //  Retire width, for top-down slots
+  uint64_t interval;        //  Cycles per record
+};
+
+struct PMURecord {
+  uint64_t cycle;           //  Cycle at the end of the interval
+  uint64_t cycles;          //  Cycles in the interval, the last one may be short
+  uint64_t instrs;
+  uint64_t counters[PMU_NR_COUNTERS];
+};
+
+static const char *const pmu_counter_names[PMU_NR_COUNTERS] = {
+  "none", "mispred", "exception", "interrupt", "csr", "jmp", "br",
+  "ret_ebreak", "ret_ecall", "mdu", "fpu",
+  "icache_access", "icache_miss", "itlb_access", "itlb_miss",
+  "dcache_read_access", "dcache_write_access", "dcache_atom_access",
+  "dcache_read_miss", "dcache_write_miss", "dcache_atom_miss",
+  "dtlb_access", "dtlb_miss", "stall", "flush", "ecall", "ebreak",
+  "td_frontend", "td_memory", "td_core", "td_bad_spec"
+};
+
+class VSimTop;
+
+class PMUSampler {
+public:
+  PMUSampler(VSimTop *dut, const char *file, uint64_t interval, uint64_t start_cycle);
+  ~PMUSampler();
+
+  //  Called once per cycle with the number of retired instructions.
+  inline void sample(uint64_t cycle, unsigned nr_commits) {
+    if (m_file == NULL) {
+      return;
+    }
+    accumulate(nr_commits);
+    if (++m_rec.cycles == m_interval) {
+      flush(cycle);
+    }
+  }
+
+private:
+  VSimTop *m_dut;
+  FILE *m_file;
+  uint64_t m_interval;
+  PMURecord m_rec;
+
+  void accumulate(unsigned nr_commits);
+  void flush(uint64_t cycle);
+};
+
+#endif
@@ -0,0 +1,134 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+#include "pmu.h"
+
+//  Offline reader for the stream written by emu --pmu.
+//  Build: make pmu-reader
+
+static void usage(const char *prog) {
+  printf("Usage: %s [-i] [-e] FILE\n", prog);
+  printf("  -i    print one line per interval\n");
+  printf("  -e    print every event total, not only the non-zero ones\n");
+}
+
+static double pct(uint64_t n, uint64_t d) {
+  return d ? 100.0 * n / d : 0.0;
+}
+
+static double per_kilo(uint64_t n, uint64_t d) {
+  return d ? 1000.0 * n / d : 0.0;
+}
+
+static void print_interval(const PMURecord &rec) {
+  uint64_t stalls = rec.counters[PMU_TD_FRONTEND] + rec.counters[PMU_TD_MEMORY] +
+                    rec.counters[PMU_TD_CORE] + rec.counters[PMU_TD_BAD_SPEC];
+  printf("%12lu %8lu %6.3f %6.1f %6.1f %6.1f %6.1f %6.1f %8.2f %8.2f\n",
+         rec.cycle, rec.cycles, rec.cycles ? (double)rec.instrs / rec.cycles : 0.0,
+         pct(rec.cycles - stalls, rec.cycles),
+         pct(rec.counters[PMU_TD_FRONTEND], rec.cycles),
+         pct(rec.counters[PMU_TD_BAD_SPEC], rec.cycles),
+         pct(rec.counters[PMU_TD_MEMORY], rec.cycles),
+         pct(rec.counters[PMU_TD_CORE], rec.cycles),
+         per_kilo(rec.counters[PMU_MISPRED], rec.instrs),
+         per_kilo(rec.counters[PMU_DCACHE_READ_MISS] + rec.counters[PMU_DCACHE_WRITE_MISS] +
+                  rec.counters[PMU_DCACHE_ATOM_MISS], rec.instrs));
+}
+
+int main(int argc, char **argv) {
+  bool intervals = false;
+  bool all_events = false;
+  int o;
+  while ((o = getopt(argc, argv, "ieh")) != -1) {
+    switch (o) {
+      case 'i': intervals = true; break;
+      case 'e': all_events = true; break;
+      default:
+        usage(argv[0]);
+        return o == 'h' ? 0 : 1;
+    }
+  }
+  if (optind >= argc) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  FILE *fp = fopen(argv[optind], "rb");
+  if (fp == NULL) {
+    printf("[ERROR] Cannot open %s\n", argv[optind]);
+    return 1;
+  }
+  PMUHeader hdr;
+  if (fread(&hdr, sizeof(hdr), 1, fp) != 1 || hdr.magic != PMU_MAGIC) {
+    printf("[ERROR] %s is not a PMU stream\n", argv[optind]);
+    return 1;
+  }
+  if (hdr.version != PMU_VERSION || hdr.nr_counters != PMU_NR_COUNTERS) {
+    printf("[ERROR] Unsupported PMU stream version %u with %u counters\n", hdr.version, hdr.nr_counters);
+    return 1;
+  }
+
+  if (intervals) {
+    printf("%12s %8s %6s %6s %6s %6s %6s %6s %8s %8s\n", "cycle", "cycles", "ipc",
+           "ret%", "fe%", "bad%", "mem%", "core%", "br-mpki", "d$-mpki");
+  }
+
+  PMURecord rec;
+  uint64_t nr_records = 0;
+  uint64_t cycles = 0;
+  uint64_t instrs = 0;
+  uint64_t c[PMU_NR_COUNTERS] = {};
+  while (fread(&rec, sizeof(rec), 1, fp) == 1) {
+    if (intervals) {
+      print_interval(rec);
+    }
+    cycles += rec.cycles;
+    instrs += rec.instrs;
+    for (int i = 0; i < PMU_NR_COUNTERS; i++) {
+      c[i] += rec.counters[i];
+    }
+    nr_records++;
+  }
+  fclose(fp);
+
+  uint64_t stalls = c[PMU_TD_FRONTEND] + c[PMU_TD_MEMORY] + c[PMU_TD_CORE] + c[PMU_TD_BAD_SPEC];
+
+  printf("\n");
+  printf("Intervals:    %lu x %lu cycles\n", nr_records, hdr.interval);
+  printf("Cycles:       %lu\n", cycles);
+  printf("Instructions: %lu\n", instrs);
+  printf("IPC:          %.3f (of %u)\n", cycles ? (double)instrs / cycles : 0.0, hdr.width);
+
+  //  Cycle-based top-down: a cycle either retires or is charged to one reason.
+  printf("\nTop-down (cycles)\n");
+  printf("  Retiring          %6.2f%%\n", pct(cycles - stalls, cycles));
+  printf("  Frontend bound    %6.2f%%\n", pct(c[PMU_TD_FRONTEND], cycles));
+  printf("  Bad speculation   %6.2f%%\n", pct(c[PMU_TD_BAD_SPEC], cycles));
+  printf("  Backend bound     %6.2f%%\n", pct(c[PMU_TD_MEMORY] + c[PMU_TD_CORE], cycles));
+  printf("    Memory bound    %6.2f%%\n", pct(c[PMU_TD_MEMORY], cycles));
+  printf("    Core bound      %6.2f%%\n", pct(c[PMU_TD_CORE], cycles));
+
+  uint64_t d_access = c[PMU_DCACHE_READ_ACCESS] + c[PMU_DCACHE_WRITE_ACCESS] + c[PMU_DCACHE_ATOM_ACCESS];
+  uint64_t d_miss = c[PMU_DCACHE_READ_MISS] + c[PMU_DCACHE_WRITE_MISS] + c[PMU_DCACHE_ATOM_MISS];
+  printf("\nRates\n");
+  printf("  Branch MPKI       %8.3f (%.2f%% of %lu br/jmp)\n", per_kilo(c[PMU_MISPRED], instrs),
+         pct(c[PMU_MISPRED], c[PMU_BR] + c[PMU_JMP]), c[PMU_BR] + c[PMU_JMP]);
+  printf("  ICache MPKI       %8.3f (miss rate %.2f%%)\n", per_kilo(c[PMU_ICACHE_MISS], instrs),
+         pct(c[PMU_ICACHE_MISS], c[PMU_ICACHE_ACCESS]));
+  printf("  ITLB MPKI         %8.3f (miss rate %.2f%%)\n", per_kilo(c[PMU_ITLB_MISS], instrs),
+         pct(c[PMU_ITLB_MISS], c[PMU_ITLB_ACCESS]));
+  printf("  DCache MPKI       %8.3f (miss rate %.2f%%)\n", per_kilo(d_miss, instrs), pct(d_miss, d_access));
+  printf("  DTLB MPKI         %8.3f (miss rate %.2f%%)\n", per_kilo(c[PMU_DTLB_MISS], instrs),
+         pct(c[PMU_DTLB_MISS], c[PMU_DTLB_ACCESS]));
+  printf("  Flushes PKI       %8.3f\n", per_kilo(c[PMU_FLUSH], instrs));
+
+  printf("\nEvents\n");
+  for (int i = 1; i < PMU_NR_EVENTS; i++) {
+    if (all_events || c[i]) {
+      printf("  %-22s %12lu\n", pmu_counter_names[i], c[i]);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,132 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ram.h"
+
+static uint8_t *ram = NULL;
+static uint64_t ram_size = 0;
+static uint64_t *ram_dirty = NULL;    //  One bit per page holding data
+
+#define DIRTY_WORD(pg) ram_dirty[(pg) / 64]
+#define DIRTY_BIT(pg)  (1UL << ((pg) % 64))
+
+static uint64_t page_round_up(uint64_t n) {
+  return (n + RAM_PAGE_SIZE - 1) & ~(RAM_PAGE_SIZE - 1);
+}
+
+static uint64_t map_image(uint8_t *mem, uint64_t mem_size, const char *img) {
+  int fd = open(img, O_RDONLY);
+  if (fd < 0) {
+    printf("[ERROR] Can not open image %s\n", img);
+    exit(1);
+  }
+
+  struct stat st;
+  fstat(fd, &st);
+  uint64_t img_size = st.st_size;
+  if (img_size > mem_size) {
+    printf("[ERROR] Image %s (%lu bytes) does not fit in %lu bytes of RAM\n", img, img_size, mem_size);
+    exit(1);
+  }
+
+  //  Private file mapping over the reserved region: untouched pages stay in
+  //  the page cache, the first store to a page gives the simulator its own copy.
+  //  The tail of the last page reads as zero.
+  if (img_size > 0) {
+    void *p = mmap(mem, page_round_up(img_size), PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_FIXED, fd, 0);
+    if (p == MAP_FAILED) {
+      printf("[ERROR] Can not map image %s\n", img);
+      exit(1);
+    }
+  }
+  close(fd);
+  printf("[INFO] Image %s mapped, size = %lu\n", img, img_size);
+  return img_size;
+}
+
+uint8_t *map_ram(const char *img, uint64_t mem_size, uint64_t *img_size) {
+  mem_size = page_round_up(mem_size);
+  void *p = mmap(NULL, mem_size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (p == MAP_FAILED) {
+    printf("[ERROR] Can not reserve %lu bytes for RAM\n", mem_size);
+    exit(1);
+  }
+  uint64_t size = img != NULL ? map_image((uint8_t *)p, mem_size, img) : 0;
+  if (img_size != NULL) {
+    *img_size = size;
+  }
+  return (uint8_t *)p;
+}
+
+void unmap_ram(uint8_t *mem, uint64_t mem_size) {
+  munmap(mem, page_round_up(mem_size));
+}
+
+void init_ram(const char *img, uint64_t mem_size) {
+  assert(ram == NULL);
+  ram_size = page_round_up(mem_size);
+  uint64_t img_size;
+  ram = map_ram(img, ram_size, &img_size);
+  ram_dirty = (uint64_t *)calloc((ram_size / RAM_PAGE_SIZE + 63) / 64, sizeof(uint64_t));
+  for (uint64_t pg = 0; pg < page_round_up(img_size) / RAM_PAGE_SIZE; pg++) {
+    ram_set_page_dirty(pg);
+  }
+}
+
+void ram_finish() {
+  if (ram != NULL) {
+    unmap_ram(ram, ram_size);
+    ram = NULL;
+    ram_size = 0;
+    free(ram_dirty);
+    ram_dirty = NULL;
+  }
+}
+
+uint8_t *get_ram_start() {
+  return ram;
+}
+
+uint64_t get_ram_size() {
+  return ram_size;
+}
+
+bool ram_page_dirty(uint64_t pg) {
+  return DIRTY_WORD(pg) & DIRTY_BIT(pg);
+}
+
+void ram_set_page_dirty(uint64_t pg) {
+  DIRTY_WORD(pg) |= DIRTY_BIT(pg);
+}
+
+extern "C" uint64_t ram_read_helper(uint8_t en, uint64_t rIdx) {
+  if (!en) {
+    return 0;
+  }
+  if (rIdx >= ram_size / sizeof(uint64_t)) {
+    printf("[ERROR] RAM read index out of bound: 0x%lx\n", rIdx);
+    return 0;
+  }
+  return ((uint64_t *)ram)[rIdx];
+}
+
+extern "C" void ram_write_helper(uint64_t wIdx, uint64_t wdata, uint64_t wmask, uint8_t wen) {
+  if (!wen) {
+    return;
+  }
+  if (wIdx >= ram_size / sizeof(uint64_t)) {
+    printf("[ERROR] RAM write index out of bound: 0x%lx\n", wIdx);
+    return;
+  }
+  uint64_t pg = wIdx * sizeof(uint64_t) / RAM_PAGE_SIZE;
+  DIRTY_WORD(pg) |= DIRTY_BIT(pg);
+  uint64_t *p = &((uint64_t *)ram)[wIdx];
+  *p = (*p & ~wmask) | (wdata & wmask);
+}
@@ -0,0 +1,31 @@
+#ifndef __RAM_H__
+#define __RAM_H__
+
+#include <cstdint>
+#include <cstddef>
+
+//  Sparse DRAM backing the RAMHelper BlackBox.
+//  The whole address space is reserved with MAP_NORESERVE, so only pages
+//  that are actually touched consume host memory. The image is mapped
+//  privately on top of it: reads share the page cache, writes are copied.
+#define RAM_PAGE_SIZE 4096UL
+
+void init_ram(const char *img, uint64_t mem_size);
+void ram_finish();
+
+//  A separate sparse mapping of the image, e.g. for a reference model.
+uint8_t *map_ram(const char *img, uint64_t mem_size, uint64_t *img_size = NULL);
+void unmap_ram(uint8_t *mem, uint64_t mem_size);
+
+uint8_t *get_ram_start();
+uint64_t get_ram_size();
+
+//  Pages of the image or written since init_ram, the only ones that can
+//  be non-zero. Lets checkpoints skip the rest without touching them.
+bool ram_page_dirty(uint64_t pg);
+void ram_set_page_dirty(uint64_t pg);
+
+extern "C" uint64_t ram_read_helper(uint8_t en, uint64_t rIdx);
+extern "C" void ram_write_helper(uint64_t wIdx, uint64_t wdata, uint64_t wmask, uint8_t wen);
+
+#endif
@@ -39,11 +39,23 @@ module RAMHelper(
   input         wen
 );
 
-  assign rdata = ram_read_helper(en, rIdx);
+  //  The C++ model is 64-bit word addressed, every beat touches two words.
+  //  Reads are registered to keep the SyncReadMem timing of AXI4Ram.
+  reg [127:0] rdata_reg;
+
+  wire [63:0] wmask_lo = {{8{wmask[7]}},  {8{wmask[6]}},  {8{wmask[5]}},  {8{wmask[4]}},
+                          {8{wmask[3]}},  {8{wmask[2]}},  {8{wmask[1]}},  {8{wmask[0]}}};
+  wire [63:0] wmask_hi = {{8{wmask[15]}}, {8{wmask[14]}}, {8{wmask[13]}}, {8{wmask[12]}},
+                          {8{wmask[11]}}, {8{wmask[10]}}, {8{wmask[9]}},  {8{wmask[8]}}};
+
+  assign rdata = rdata_reg;
 
   always @(posedge clk) begin
-    ram_write_helper(wIdx, wdata, wmask, wen && en);
+    if (en) begin
+      rdata_reg <= {ram_read_helper(en, {11'b0, rIdx, 1'b1}), ram_read_helper(en, {11'b0, rIdx, 1'b0})};
+    end
+    ram_write_helper({11'b0, wIdx, 1'b0}, wdata[63:0],   wmask_lo, wen);
+    ram_write_helper({11'b0, wIdx, 1'b1}, wdata[127:64], wmask_hi, wen);
   end
 
 endmodule
-
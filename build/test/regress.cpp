@@ -0,0 +1,382 @@
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <climits>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+//  Parallel regression runner: one emulator process per job, at most -j of
+//  them at a time. Every worker execs the same VSimTop binary, so the
+//  Verilated model's code is mapped from the page cache once and shared
+//  read-only; a worker only owns its model state and the RAM pages it
+//  writes (the image itself is a private file mapping, see ram.cpp).
+//  Use a single-threaded profile (emu-notrace) with one worker per core.
+//  Build: make regress
+
+#define DEFAULT_EMU       "obj_dir/VSimTop"
+#define DEFAULT_OUT_DIR   "regress"
+#define DEFAULT_TIMEOUT   600
+#define POLL_US           20000
+
+struct Job {
+  std::string name;
+  std::string image;
+  std::vector<std::string> args;
+  std::string dir;
+
+  pid_t pid = 0;
+  double start = 0;
+  double seconds = 0;
+  bool killed = false;          //  Hit the host timeout
+  bool interrupted = false;     //  Killed on SIGINT/SIGTERM
+  int exit_code = -1;
+  int signal = 0;
+  std::string status = "skipped";
+  uint64_t cycles = 0;
+  uint64_t instrs = 0;
+  double ipc = 0;
+};
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void on_interrupt(int) {
+  interrupted = 1;
+}
+
+static double host_seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void usage(const char *prog) {
+  printf("Usage: %s [options] [image ...]\n", prog);
+  printf("  -e FILE     emulator binary (default: %s)\n", DEFAULT_EMU);
+  printf("  -f FILE     job list, one \"image [emu options]\" per line, # starts a comment\n");
+  printf("  -j N        parallel workers (default: online cores)\n");
+  printf("  -t SECONDS  kill a job after SECONDS of host time (default: %d, 0 disables)\n", DEFAULT_TIMEOUT);
+  printf("  -o DIR      output directory, one subdirectory per job (default: %s)\n", DEFAULT_OUT_DIR);
+  printf("  -a ARGS     emulator options for every job, e.g. -a \"--diff -C 1000000\"\n");
+  printf("Writes DIR/report.json and DIR/report.csv, exits 1 if any job did not pass.\n");
+}
+
+static std::vector<std::string> split(const char *s) {
+  std::vector<std::string> words;
+  std::string w;
+  for (; *s; s++) {
+    if (*s == ' ' || *s == '\t' || *s == '\n' || *s == '\r') {
+      if (!w.empty()) {
+        words.push_back(w);
+        w.clear();
+      }
+    } else {
+      w += *s;
+    }
+  }
+  if (!w.empty()) {
+    words.push_back(w);
+  }
+  return words;
+}
+
+static std::string abs_path(const std::string &path) {
+  char buf[PATH_MAX];
+  if (realpath(path.c_str(), buf) == NULL) {
+    printf("[ERROR] Cannot find %s\n", path.c_str());
+    exit(1);
+  }
+  return buf;
+}
+
+static void add_job(std::vector<Job> &jobs, const std::string &image, const std::vector<std::string> &args) {
+  Job job;
+  job.image = abs_path(image);
+  job.args = args;
+  const char *base = strrchr(job.image.c_str(), '/') + 1;
+  const char *dot = strrchr(base, '.');
+  job.name = dot && dot != base ? std::string(base, dot - base) : std::string(base);
+  jobs.push_back(job);
+}
+
+static void load_list(std::vector<Job> &jobs, const char *file) {
+  FILE *fp = fopen(file, "r");
+  if (fp == NULL) {
+    printf("[ERROR] Cannot open %s\n", file);
+    exit(1);
+  }
+  char line[4096];
+  while (fgets(line, sizeof(line), fp)) {
+    char *comment = strchr(line, '#');
+    if (comment) {
+      *comment = '\0';
+    }
+    std::vector<std::string> words = split(line);
+    if (!words.empty()) {
+      add_job(jobs, words[0], std::vector<std::string>(words.begin() + 1, words.end()));
+    }
+  }
+  fclose(fp);
+}
+
+//  ********************************************
+//  Workers
+static void spawn(Job &job, const std::string &emu, const std::vector<std::string> &common) {
+  mkdir(job.dir.c_str(), 0755);
+  job.start = host_seconds();
+  //  Or the child's copy of unflushed output ends up in emu.log.
+  fflush(stdout);
+  job.pid = fork();
+  if (job.pid < 0) {
+    printf("[ERROR] fork: %s\n", strerror(errno));
+    exit(1);
+  }
+  if (job.pid > 0) {
+    return;
+  }
+
+  //  Child: run in the job directory, checkpoints and traces land there too.
+  signal(SIGINT, SIG_DFL);
+  signal(SIGTERM, SIG_DFL);
+  if (chdir(job.dir.c_str()) != 0) {
+    _exit(127);
+  }
+  int fd = open("emu.log", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    _exit(127);
+  }
+  dup2(fd, STDOUT_FILENO);
+  dup2(fd, STDERR_FILENO);
+  close(fd);
+
+  std::vector<const char *> argv;
+  argv.push_back(emu.c_str());
+  argv.push_back("-i");
+  argv.push_back(job.image.c_str());
+  for (const std::string &a : common) {
+    argv.push_back(a.c_str());
+  }
+  for (const std::string &a : job.args) {
+    argv.push_back(a.c_str());
+  }
+  argv.push_back(NULL);
+  execv(emu.c_str(), (char *const *)argv.data());
+  //  stdio buffers are discarded by _exit()
+  dprintf(STDERR_FILENO, "[ERROR] Cannot run %s: %s\n", emu.c_str(), strerror(errno));
+  _exit(127);
+}
+
+//  Exit codes of emu, see usage() in emu.cpp
+static const char *exit_status(int code) {
+  switch (code) {
+    case 0:   return "pass";
+    case 1:   return "bad_trap";
+    case 2:   return "assert";
+    case 3:   return "stuck";
+    case 4:   return "timeout";
+    case 5:   return "difftest";
+    case 6:   return "finish";
+    case 7:   return "limit";
+    case 127: return "error";
+    default:  return "fail";
+  }
+}
+
+static void parse_log(Job &job) {
+  std::string log = job.dir + "/emu.log";
+  FILE *fp = fopen(log.c_str(), "r");
+  if (fp == NULL) {
+    return;
+  }
+  char line[1024];
+  while (fgets(line, sizeof(line), fp)) {
+    const char *p = strstr(line, "Cycles: ");
+    if (p != NULL) {
+      sscanf(p, "Cycles: %lu, Instructions: %lu, IPC: %lf", &job.cycles, &job.instrs, &job.ipc);
+    }
+  }
+  fclose(fp);
+}
+
+static void finish(Job &job, int wstatus) {
+  job.seconds = host_seconds() - job.start;
+  job.pid = 0;
+  if (job.interrupted) {
+    job.status = "interrupted";
+  } else if (job.killed) {
+    job.status = "host_timeout";
+  } else if (WIFSIGNALED(wstatus)) {
+    job.signal = WTERMSIG(wstatus);
+    job.status = "crash";
+  } else {
+    job.exit_code = WEXITSTATUS(wstatus);
+    job.status = exit_status(job.exit_code);
+  }
+  parse_log(job);
+}
+
+//  ********************************************
+//  Report
+static std::string json_str(const std::string &s) {
+  std::string out = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+    }
+    out += c;
+  }
+  return out + "\"";
+}
+
+//  RFC 4180: quoted, embedded quotes doubled.
+static std::string csv_str(const std::string &s) {
+  std::string out = "\"";
+  for (char c : s) {
+    if (c == '"') {
+      out += '"';
+    }
+    out += c;
+  }
+  return out + "\"";
+}
+
+static void write_report(const std::string &out_dir, const std::string &emu,
+                         const std::vector<Job> &jobs, unsigned nr_workers, unsigned nr_pass) {
+  std::string csv_file = out_dir + "/report.csv";
+  std::string json_file = out_dir + "/report.json";
+  FILE *csv = fopen(csv_file.c_str(), "w");
+  FILE *json = fopen(json_file.c_str(), "w");
+  if (csv == NULL || json == NULL) {
+    printf("[ERROR] Cannot write the report to %s\n", out_dir.c_str());
+    exit(1);
+  }
+
+  fprintf(csv, "name,status,exit_code,signal,cycles,instrs,ipc,seconds,image,dir\n");
+  fprintf(json, "{\n  \"emu\": %s,\n  \"workers\": %u,\n", json_str(emu).c_str(), nr_workers);
+  fprintf(json, "  \"total\": %zu,\n  \"pass\": %u,\n  \"fail\": %zu,\n  \"jobs\": [\n",
+          jobs.size(), nr_pass, jobs.size() - nr_pass);
+  for (size_t i = 0; i < jobs.size(); i++) {
+    const Job &j = jobs[i];
+    fprintf(csv, "%s,%s,%d,%d,%lu,%lu,%.4f,%.3f,%s,%s\n", csv_str(j.name).c_str(), j.status.c_str(),
+            j.exit_code, j.signal, j.cycles, j.instrs, j.ipc, j.seconds, csv_str(j.image).c_str(),
+            csv_str(j.dir).c_str());
+    fprintf(json, "    { \"name\": %s, \"status\": \"%s\", \"exit_code\": %d, \"signal\": %d, "
+                  "\"cycles\": %lu, \"instrs\": %lu, \"ipc\": %.4f, \"seconds\": %.3f, "
+                  "\"image\": %s, \"dir\": %s }%s\n",
+            json_str(j.name).c_str(), j.status.c_str(), j.exit_code, j.signal, j.cycles, j.instrs,
+            j.ipc, j.seconds, json_str(j.image).c_str(), json_str(j.dir).c_str(),
+            i + 1 < jobs.size() ? "," : "");
+  }
+  fprintf(json, "  ]\n}\n");
+  fclose(csv);
+  fclose(json);
+  printf("[INFO] Report written to %s and %s\n", json_file.c_str(), csv_file.c_str());
+}
+
+int main(int argc, char **argv) {
+  std::string emu = DEFAULT_EMU;
+  std::string out_dir = DEFAULT_OUT_DIR;
+  std::vector<std::string> common;
+  std::vector<Job> jobs;
+  long nr_workers = sysconf(_SC_NPROCESSORS_ONLN);
+  double timeout = DEFAULT_TIMEOUT;
+  int o;
+
+  while ((o = getopt(argc, argv, "e:f:j:t:o:a:h")) != -1) {
+    switch (o) {
+      case 'e': emu = optarg; break;
+      case 'f': load_list(jobs, optarg); break;
+      case 'j': nr_workers = strtol(optarg, NULL, 0); break;
+      case 't': timeout = strtod(optarg, NULL); break;
+      case 'o': out_dir = optarg; break;
+      case 'a': common = split(optarg); break;
+      default:
+        usage(argv[0]);
+        return o == 'h' ? 0 : 1;
+    }
+  }
+  for (int i = optind; i < argc; i++) {
+    add_job(jobs, argv[i], std::vector<std::string>());
+  }
+  if (jobs.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+  if (nr_workers < 1) {
+    nr_workers = 1;
+  }
+
+  emu = abs_path(emu);
+  mkdir(out_dir.c_str(), 0755);
+  out_dir = abs_path(out_dir);
+  for (size_t i = 0; i < jobs.size(); i++) {
+    char dir[32];
+    snprintf(dir, sizeof(dir), "/%04zu-", i);
+    jobs[i].dir = out_dir + dir + jobs[i].name;
+  }
+  printf("[INFO] %zu jobs on %ld workers, emulator %s\n", jobs.size(), nr_workers, emu.c_str());
+  signal(SIGINT, on_interrupt);
+  signal(SIGTERM, on_interrupt);
+
+  //  Job queue: keep nr_workers children busy, reap them as they exit.
+  std::vector<size_t> running;
+  size_t next = 0;
+  size_t done = 0;
+  unsigned nr_pass = 0;
+  double start = host_seconds();
+  while (next < jobs.size() || !running.empty()) {
+    while (!interrupted && next < jobs.size() && running.size() < (size_t)nr_workers) {
+      spawn(jobs[next], emu, common);
+      running.push_back(next++);
+    }
+    if (interrupted && next < jobs.size()) {
+      printf("[WARN] Interrupted, %zu jobs not started\n", jobs.size() - next);
+      next = jobs.size();
+    }
+
+    int wstatus;
+    pid_t pid = waitpid(-1, &wstatus, WNOHANG);
+    if (pid > 0) {
+      for (size_t r = 0; r < running.size(); r++) {
+        Job &job = jobs[running[r]];
+        if (job.pid != pid) {
+          continue;
+        }
+        finish(job, wstatus);
+        nr_pass += job.status == "pass";
+        printf("[%s] [%zu/%zu] %-24s %-12s %12lu cycles  IPC %.3f  %.1f s\n",
+               job.status == "pass" ? "INFO" : "ERROR", ++done, jobs.size(), job.name.c_str(),
+               job.status.c_str(), job.cycles, job.ipc, job.seconds);
+        running.erase(running.begin() + r);
+        break;
+      }
+      continue;
+    }
+
+    double now = host_seconds();
+    for (size_t r : running) {
+      Job &job = jobs[r];
+      if (job.killed || job.interrupted) {
+        continue;
+      }
+      if (interrupted) {
+        kill(job.pid, SIGKILL);
+        job.interrupted = true;
+      } else if (timeout > 0 && now - job.start > timeout) {
+        kill(job.pid, SIGKILL);
+        job.killed = true;
+      }
+    }
+    usleep(POLL_US);
+  }
+
+  printf("[INFO] %u/%zu passed in %.1f s\n", nr_pass, jobs.size(), host_seconds() - start);
+  write_report(out_dir, emu, jobs, nr_workers, nr_pass);
+  return nr_pass == jobs.size() ? 0 : 1;
+}
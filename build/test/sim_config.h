@@ -0,0 +1,9 @@
+#ifndef __SIM_CONFIG_H__
+#define __SIM_CONFIG_H__
+
+//  Generated by SimTop, do not edit.
+
+#define SIM_RETIRE_WIDTH 4
+#define SIM_FOR_EACH_RETIRE(X) X(0) X(1) X(2) X(3)
+
+#endif
@@ -0,0 +1,176 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "snapshot.h"
+#include "ram.h"
+
+#define CHECKPOINT_MAGIC 0x7a69726b70740002UL   //  "zirkpt" + version
+#define CHECKPOINT_PAGE_END (~0UL)
+
+//  ********************************************
+//  VerilatedGzSave
+void VerilatedGzSave::open(const char *filename) {
+  if (isOpen()) {
+    return;
+  }
+  //  Level 1: snapshots are written while the simulation is paused.
+  m_file = gzopen(filename, "wb1");
+  if (m_file == NULL) {
+    printf("[ERROR] Can not open checkpoint %s\n", filename);
+    exit(1);
+  }
+  m_filename = filename;
+  m_isOpen = true;
+  header();
+}
+
+void VerilatedGzSave::close() {
+  if (!isOpen()) {
+    return;
+  }
+  trailer();
+  flush();
+  m_isOpen = false;
+  gzclose(m_file);
+  m_file = NULL;
+}
+
+void VerilatedGzSave::flush() {
+  if (!isOpen()) {
+    return;
+  }
+  unsigned len = m_cp - m_bufp;
+  if (len && gzwrite(m_file, m_bufp, len) != (int)len) {
+    printf("[ERROR] Write checkpoint %s failed\n", m_filename.c_str());
+    exit(1);
+  }
+  m_cp = m_bufp;
+}
+
+//  ********************************************
+//  VerilatedGzRestore
+void VerilatedGzRestore::open(const char *filename) {
+  if (isOpen()) {
+    return;
+  }
+  m_file = gzopen(filename, "rb");
+  if (m_file == NULL) {
+    printf("[ERROR] Can not open checkpoint %s\n", filename);
+    exit(1);
+  }
+  m_filename = filename;
+  m_isOpen = true;
+  m_cp = m_bufp;
+  m_endp = m_bufp;
+  header();
+}
+
+void VerilatedGzRestore::close() {
+  if (!isOpen()) {
+    return;
+  }
+  trailer();
+  flush();
+  m_isOpen = false;
+  gzclose(m_file);
+  m_file = NULL;
+}
+
+void VerilatedGzRestore::fill() {
+  if (!isOpen()) {
+    return;
+  }
+  //  Move the unread bytes to the front, then top the buffer up.
+  unsigned left = m_endp - m_cp;
+  memmove(m_bufp, m_cp, left);
+  m_cp = m_bufp;
+  m_endp = m_bufp + left;
+
+  unsigned room = m_bufp + bufferSize() - m_endp;
+  int got = gzread(m_file, m_endp, room);
+  if (got < 0) {
+    printf("[ERROR] Read checkpoint %s failed\n", m_filename.c_str());
+    exit(1);
+  }
+  m_endp += got;
+}
+
+//  ********************************************
+//  Checkpoint
+static bool page_is_zero(const uint64_t *p) {
+  for (unsigned i = 0; i < RAM_PAGE_SIZE / sizeof(uint64_t); i++) {
+    if (p[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void save_checkpoint(VSimTop *dut, const char *filename, uint64_t sim_time, uint64_t instrs) {
+  VerilatedGzSave os;
+  os.open(filename);
+
+  vluint64_t magic = CHECKPOINT_MAGIC;
+  vluint64_t time = sim_time;
+  vluint64_t nr_instrs = instrs;
+  vluint64_t ram_size = get_ram_size();
+  os << magic << time << nr_instrs << ram_size;
+  os << *dut;
+
+  //  Only pages that hold data are stored, the rest are implicitly zero.
+  //  Pages never written are not read at all, so they stay unmapped.
+  uint8_t *ram = get_ram_start();
+  uint64_t nr_pages = 0;
+  for (vluint64_t pg = 0; pg < ram_size / RAM_PAGE_SIZE; pg++) {
+    uint8_t *p = ram + pg * RAM_PAGE_SIZE;
+    if (!ram_page_dirty(pg) || page_is_zero((uint64_t *)p)) {
+      continue;
+    }
+    os << pg;
+    os.write(p, RAM_PAGE_SIZE);
+    nr_pages++;
+  }
+  vluint64_t end = CHECKPOINT_PAGE_END;
+  os << end;
+  os.close();
+
+  printf("[INFO] Checkpoint %s saved at sim_time %lu, %lu RAM pages\n", filename, sim_time, nr_pages);
+}
+
+uint64_t restore_checkpoint(VSimTop *dut, const char *filename, uint64_t &instrs) {
+  VerilatedGzRestore os;
+  os.open(filename);
+
+  vluint64_t magic, time, nr_instrs, ram_size;
+  os >> magic;
+  if (magic != CHECKPOINT_MAGIC) {
+    printf("[ERROR] %s is not a checkpoint of this version\n", filename);
+    exit(1);
+  }
+  os >> time >> nr_instrs >> ram_size;
+  instrs = nr_instrs;
+  os >> *dut;
+
+  //  Restore into a fresh zero RAM, the saved pages already contain the image.
+  ram_finish();
+  init_ram(NULL, ram_size);
+  uint8_t *ram = get_ram_start();
+  while (true) {
+    vluint64_t pg;
+    os >> pg;
+    if (pg == CHECKPOINT_PAGE_END) {
+      break;
+    }
+    if (pg >= ram_size / RAM_PAGE_SIZE) {
+      printf("[ERROR] Checkpoint %s is corrupted\n", filename);
+      exit(1);
+    }
+    os.read(ram + pg * RAM_PAGE_SIZE, RAM_PAGE_SIZE);
+    ram_set_page_dirty(pg);
+  }
+  os.close();
+
+  printf("[INFO] Checkpoint %s restored at sim_time %lu\n", filename, time);
+  return time;
+}
@@ -0,0 +1,41 @@
+#ifndef __SNAPSHOT_H__
+#define __SNAPSHOT_H__
+
+#include <cstdint>
+#include <zlib.h>
+#include <verilated_save.h>
+
+#include "VSimTop.h"
+
+//  gzip backed streams for Verilator save/restore (build with --savable).
+class VerilatedGzSave : public VerilatedSerialize {
+  gzFile m_file;
+
+public:
+  VerilatedGzSave() : m_file(NULL) {}
+  virtual ~VerilatedGzSave() { close(); }
+  void open(const char *filename);
+  virtual void close();
+  virtual void flush();
+};
+
+class VerilatedGzRestore : public VerilatedDeserialize {
+  gzFile m_file;
+
+public:
+  VerilatedGzRestore() : m_file(NULL) {}
+  virtual ~VerilatedGzRestore() { close(); }
+  void open(const char *filename);
+  virtual void close();
+  virtual void flush() {}
+  virtual void fill();
+};
+
+//  A checkpoint holds the whole VSimTop state, sim_time, the number of
+//  retired instructions and the non-zero pages of the external RAM.
+//  Restoring one and running on is bit for bit identical to the
+//  uninterrupted run.
+void save_checkpoint(VSimTop *dut, const char *filename, uint64_t sim_time, uint64_t instrs);
+uint64_t restore_checkpoint(VSimTop *dut, const char *filename, uint64_t &instrs);
+
+#endif
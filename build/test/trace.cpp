@@ -0,0 +1,137 @@
+#include <cstdio>
+#include <unistd.h>
+
+#include "trace.h"
+#include "sim_config.h"
+
+#if VM_TRACE
+#include <verilated_fst_c.h>
+
+#define RETIRE_PC_MATCH(w)  || (m_dut->io_retire_##w##_valid && m_dut->io_retire_##w##_pc == pc)
+
+Tracer::Tracer(VSimTop *dut, const TraceConfig &cfg)
+  : m_dut(dut), m_cfg(cfg), m_trace(NULL), m_enable(false), m_has_window(false),
+    m_pc_until(0), m_triggered(false), m_seg(0), m_seg_begin(0) {
+  if (m_cfg.file == NULL) {
+    return;
+  }
+  m_enable = true;
+  m_has_window = m_cfg.begin || m_cfg.end || m_cfg.log_window || m_cfg.pc_match;
+
+  Verilated::traceEverOn(true);
+  m_trace = new VerilatedFstC();
+  m_dut->trace(m_trace, 99);
+
+  if (m_cfg.ring_cycles) {
+    std::string stem(m_cfg.file);
+    if (stem.size() > 4 && stem.compare(stem.size() - 4, 4, ".fst") == 0) {
+      stem.resize(stem.size() - 4);
+    }
+    m_stem = stem;
+    m_seg_name[0] = stem + "_ring0.fst";
+    m_seg_name[1] = stem + "_ring1.fst";
+    m_trace->open(m_seg_name[0].c_str());
+  } else {
+    m_trace->open(m_cfg.file);
+  }
+}
+
+Tracer::~Tracer() {
+  if (m_trace == NULL) {
+    return;
+  }
+  if (m_trace->isOpen()) {
+    m_trace->close();
+  }
+  delete m_trace;
+
+  //  Nothing went wrong, the ring is not worth keeping.
+  if (m_cfg.ring_cycles && !m_triggered) {
+    unlink(m_seg_name[0].c_str());
+    unlink(m_seg_name[1].c_str());
+  }
+}
+
+bool Tracer::retired_pc_match() {
+  uint64_t pc = m_cfg.pc;
+  return false SIM_FOR_EACH_RETIRE(RETIRE_PC_MATCH);
+}
+
+bool Tracer::in_window(uint64_t cycle) {
+  if (!m_has_window) {
+    return true;
+  }
+  if ((m_cfg.begin || m_cfg.end) && cycle >= m_cfg.begin && (!m_cfg.end || cycle < m_cfg.end)) {
+    return true;
+  }
+  if (m_cfg.log_window && cycle >= m_cfg.log_begin && cycle < m_cfg.log_end) {
+    return true;
+  }
+  return cycle < m_pc_until;
+}
+
+void Tracer::rotate(uint64_t cycle) {
+  m_trace->close();
+  m_seg ^= 1;
+  m_trace->open(m_seg_name[m_seg].c_str());
+  m_seg_begin = cycle;
+}
+
+void Tracer::step(uint64_t sim_time) {
+  uint64_t cycle = sim_time / 2;
+
+  if (m_cfg.pc_match && retired_pc_match()) {
+    m_pc_until = cycle + m_cfg.pc_cycles;
+  }
+  if (!in_window(cycle)) {
+    return;
+  }
+  if (m_cfg.ring_cycles && cycle - m_seg_begin >= m_cfg.ring_cycles) {
+    rotate(cycle);
+  }
+  m_trace->dump(sim_time);
+}
+
+void Tracer::trigger(const char *reason, uint64_t sim_time) {
+  if (!m_enable) {
+    return;
+  }
+  printf("[INFO] Trace triggered by %s at cycle %lu\n", reason, sim_time / 2);
+  m_enable = false;
+  m_triggered = true;
+
+  if (!m_cfg.ring_cycles) {
+    m_trace->flush();
+    return;
+  }
+
+  //  The older segment goes first, together they cover at least ring_cycles.
+  m_trace->close();
+  for (unsigned i = 0; i < 2; i++) {
+    const std::string &seg = m_seg_name[m_seg ^ 1 ^ i];
+    if (access(seg.c_str(), F_OK) != 0) {
+      continue;
+    }
+    std::string out = m_stem + "_" + std::to_string(sim_time / 2) + "_" + std::to_string(i) + ".fst";
+    rename(seg.c_str(), out.c_str());
+    printf("[INFO]    %s\n", out.c_str());
+  }
+}
+
+#else   //  VM_TRACE
+
+Tracer::Tracer(VSimTop *dut, const TraceConfig &cfg)
+  : m_dut(dut), m_cfg(cfg), m_trace(NULL), m_enable(false), m_has_window(false),
+    m_pc_until(0), m_triggered(false), m_seg(0), m_seg_begin(0) {
+  if (m_cfg.file != NULL) {
+    printf("[WARN] Built without tracing, %s will not be written\n", m_cfg.file);
+  }
+}
+
+Tracer::~Tracer() {}
+
+void Tracer::step(uint64_t sim_time) {}
+
+void Tracer::trigger(const char *reason, uint64_t sim_time) {}
+
+#endif  //  VM_TRACE
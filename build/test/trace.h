@@ -0,0 +1,68 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <cstdint>
+#include <string>
+
+#include "VSimTop.h"
+
+class VerilatedFstC;
+
+//  Waveform tracing is off unless a file is given. Once on, dumping is
+//  gated per cycle by the triggers below; with none of them set the
+//  whole run is traced. Without --trace-fst (VM_TRACE=0) it compiles out.
+struct TraceConfig {
+  const char *file = NULL;        //  FST output, NULL disables tracing
+
+  uint64_t begin = 0;             //  Cycle range [begin, end), end = 0 means unbounded
+  uint64_t end = 0;
+
+  bool log_window = false;        //  Follow io_logCtrl_log_begin/log_end
+  uint64_t log_begin = 0;
+  uint64_t log_end = 0;
+
+  bool pc_match = false;          //  Trace pc_cycles cycles after pc retires
+  uint64_t pc = 0;
+  uint64_t pc_cycles = 1000;
+
+  uint64_t ring_cycles = 0;       //  Keep only the last N cycles until trigger()
+};
+
+class Tracer {
+public:
+  Tracer(VSimTop *dut, const TraceConfig &cfg);
+  ~Tracer();
+
+  //  Called after every eval(). Inactive cycles cost one branch.
+  inline void dump(uint64_t sim_time) {
+    if (!m_enable) {
+      return;
+    }
+    step(sim_time);
+  }
+
+  //  Something went wrong: keep what the ring holds.
+  void trigger(const char *reason, uint64_t sim_time);
+
+private:
+  VSimTop *m_dut;
+  TraceConfig m_cfg;
+  VerilatedFstC *m_trace;
+  bool m_enable;
+  bool m_has_window;
+  uint64_t m_pc_until;
+  bool m_triggered;
+
+  //  Ring segments
+  std::string m_stem;
+  std::string m_seg_name[2];
+  unsigned m_seg;
+  uint64_t m_seg_begin;
+
+  void step(uint64_t sim_time);
+  bool retired_pc_match();
+  bool in_window(uint64_t cycle);
+  void rotate(uint64_t cycle);
+};
+
+#endif
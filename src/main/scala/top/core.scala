@@ -219,7 +219,7 @@ class ZirconCore(implicit p: Parameters) extends BaseZirconModule with ScalarOpC
   csr.io.perf.is_ebreak            := rob.io.perf.ebreak
   csr.io.perf.is_ecall             := rob.io.perf.ecall
   csr.io.perf.mispred              := rob.io.perf.mispred
-  csr.io.perf.stall                := DontCare
+  csr.io.perf.stall                := rob.io.perf.stall_fe | rob.io.perf.stall_mem | rob.io.perf.stall_core
   csr.io.perf.flush                := rob.io.kill.valid
   csr.io.ret                       := rob.io.rets.bits.map(_.valid & rob.io.rets.valid)
   csr.io.interrupts                <> rob.io.interrupts
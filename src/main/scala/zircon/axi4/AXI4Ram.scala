@@ -187,9 +187,9 @@ class AXI4Ram(memByte: Int, useBlackBox: Boolean = false)(implicit p: Parameters
     mem.io.rIdx   := rIdx
     mem.io.wIdx   := wIdx
     mem.io.wdata  := io_in.w.bits.data
-    mem.io.wmask  := fullMask.U
-    mem.io.wen    := io_in.w.fire && (wIdx < (memByte / 8 ).U)
-    mem.io.en     := true.B
+    mem.io.wmask  := io_in.w.bits.strb
+    mem.io.wen    := mem_wr_en && (wIdx < (memByte / DataByte).U)
+    mem.io.en     := mem_rd_en
     mem.io.rdata
   } else {
     val ram = SyncReadMem(memByte / DataByte, Vec(DataByte, UInt(8.W)))
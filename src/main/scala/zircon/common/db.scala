@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2022 Lyn
+ * Skew is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *         http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+package zircon.common
+
+import chisel3._
+import freechips.rocketchip.config._
+
+//  ChiselDB table rows, logged when env.EnableChiselDB is set.
+//  Every column is at most 64 bits, at most 8 columns per table.
+
+class CommitDBEntry(implicit p: Parameters) extends BaseZirconBundle with ScalarOpConstants {
+  val pc        = UInt(vaddrBits.W)
+  val rob_id    = UInt(robIdBits.W)
+  val uopc      = UInt(UOP_SZ.W)
+  val rvc       = Bool()
+  val rd_valid  = Bool()
+  val rd        = UInt(lregSz.W)
+  val taken     = Bool()
+  val target    = UInt(vaddrBits.W)
+}
+
+class CacheRefillDBEntry(implicit p: Parameters) extends BaseZirconBundle {
+  val addr      = UInt(paddrBits.W)
+  val way       = UInt(8.W)
+  val set       = UInt(16.W)
+}
+
+class TLBRefillDBEntry(implicit p: Parameters) extends BaseZirconBundle {
+  val vaddr     = UInt(vaddrBits.W)
+  val asid      = UInt(asIdBits.W)
+  val prv       = UInt(2.W)
+  val level     = UInt(lgPgLevels.W)
+  val ppn       = UInt(ppnBits.W)
+  val perm      = UInt(7.W)   //  d a g u x w r
+  val way       = UInt(8.W)
+  val set       = UInt(16.W)
+}
@@ -33,6 +33,8 @@ case class ZirconTileParams (
 
 case class DebugOptions (
                         EnableDifftest: Boolean = false,
+                        EnableChiselDB: Boolean = false,
+                        EnableLog: Boolean = false,
                         UseDRAMSim: Boolean = true
                         )
 
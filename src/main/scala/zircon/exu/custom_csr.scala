@@ -13,6 +13,7 @@ package zircon.exu
 
 import chisel3._
 import chisel3.util._
+import chisel3.util.experimental.BoringUtils
 import freechips.rocketchip.config._
 import freechips.rocketchip.rocket._
 import freechips.rocketchip.tile.FPConstants
@@ -764,6 +765,11 @@ class CustomCSRs(implicit p: Parameters) extends BaseZirconModule {
   )
   val support_mhpevts = VecInit(imp_mhpevts ++ Seq.fill(xLen-imp_mhpevts.size) { false.B })
 
+  //  Simulation: raw event vector for the harness PMU sampler
+  BoringUtils.addSource(VecInit(imp_mhpevts).asUInt, "PMU_EVENTS")
+  BoringUtils.addSource(PopCount(io.perf.is_mdus), "PMU_MDUS")
+  BoringUtils.addSource(PopCount(io.perf.is_fpus), "PMU_FPUS")
+
   for (n <- 0 until nPerfCounters) {
     val which_event = reg_mhpmevents(n)(hpmEvtBits-1,0)
     val hpmevt_ena = !reg_mcountinhibit(which_event) && !which_event.orR
@@ -786,6 +792,32 @@ class CustomCSRs(implicit p: Parameters) extends BaseZirconModule {
   when (wfi_ena) { reg_wfi := wfi_nxt }
 
   io.stall := reg_wfi
+
+  //  Simulation: ebreak ends bare-metal runs, a0 holds the trap code
+  BoringUtils.addSource(io.xpt.valid && ebreak, "TRAP_VALID")
+  BoringUtils.addSource(io.xpt.bits.addr, "TRAP_PC")
+
+  //  Simulation: trap events and trap CSRs for difftest
+  BoringUtils.addSource((io.xpt.valid && (ecall || ebreak || xpt)) || mret || sret, "DIFF_XPT")
+  BoringUtils.addSource(intr_vld, "DIFF_INTR")
+  BoringUtils.addSource(cause, "DIFF_CAUSE")
+  BoringUtils.addSource(reg_prv, "DIFF_PRV")
+  BoringUtils.addSource(read_mepc, "DIFF_MEPC")
+  BoringUtils.addSource(read_mcause, "DIFF_MCAUSE")
+  BoringUtils.addSource(read_sepc, "DIFF_SEPC")
+  BoringUtils.addSource(read_scause, "DIFF_SCAUSE")
+  BoringUtils.addSource(read_satp, "DIFF_SATP")
+  BoringUtils.addSource(read_mstatus, "DIFF_MSTATUS")
+  BoringUtils.addSource(read_mie, "DIFF_MIE")
+  BoringUtils.addSource(read_mip, "DIFF_MIP")
+  BoringUtils.addSource(read_mtvec, "DIFF_MTVEC")
+  BoringUtils.addSource(read_stvec, "DIFF_STVEC")
+  BoringUtils.addSource(read_mtval, "DIFF_MTVAL")
+  BoringUtils.addSource(read_stval, "DIFF_STVAL")
+  BoringUtils.addSource(read_mscratch, "DIFF_MSCRATCH")
+  BoringUtils.addSource(read_sscratch, "DIFF_SSCRATCH")
+  BoringUtils.addSource(read_medeleg, "DIFF_MEDELEG")
+  BoringUtils.addSource(read_mideleg, "DIFF_MIDELEG")
   io.tvm := reg_mstatus.tvm
   io.tsr := reg_mstatus.tsr
   io.sum := reg_mstatus.sum
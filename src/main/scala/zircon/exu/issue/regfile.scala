@@ -13,6 +13,7 @@ package zircon.exu
 
 import chisel3._
 import chisel3.util._
+import chisel3.util.experimental.BoringUtils
 import freechips.rocketchip.config._
 import zircon.common._
 import difftest._
@@ -76,6 +77,14 @@ class RegFile(
     //   .scanLeft(read_datas(n)) { case (old_data, (lreg, new_data)) => Mux(lreg === io.read_ports(n).addr, new_data, old_data) }
   }
 
+  //  Simulation: a0 carries the trap code, the whole file is checked by difftest
+  if (!float) {
+    BoringUtils.addSource(regfiles(10), "TRAP_CODE")
+    for (i <- 0 until numRegisters) {
+      BoringUtils.addSource(regfiles(i), s"DIFF_GPR_$i")
+    }
+  }
+
   //  Difftest
   if (env.EnableDifftest && !float) {
     val difftest = Module(new DifftestArchIntRegState)
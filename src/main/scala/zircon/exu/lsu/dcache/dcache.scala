@@ -189,10 +189,11 @@ class DCacheModule(implicit p: Parameters) extends BaseZirconModule with MemoryO
   //  1.  PTW Response Valid.
   //  2.  Has No Exception.
   //  3.  No Invalidation.
-  when (io.mem.resp.fire && !io.mem.resp.bits.cause.orR && !io.sfence.valid) {
-    printf("[INFO] DCache Refill\n")
-    printf("[INFO]    Address: 0x%x, Way: %d, Set: %d\n", req_addr, refill_way, refill_idx)
-    printf("[INFO]    Data: 0x%x\n", refill_data)
+  val do_refill = io.mem.resp.fire && !io.mem.resp.bits.cause.orR && !io.sfence.valid
+  EventLog(do_refill, LogLevel.INFO, "DCache Refill", "addr 0x%lx, way %lu, set %lu, data[63:0] 0x%lx",
+           req_addr, refill_way, refill_idx, refill_data(63, 0))
+
+  when (do_refill) {
     for (w <- 0 until dcacheParams.nWays) {
       when (w.U === refill_way) {
         tag_array(refill_idx)(w) := refill_tag.asUInt
@@ -201,6 +202,15 @@ class DCacheModule(implicit p: Parameters) extends BaseZirconModule with MemoryO
     data_array.write(refill_idx, VecInit(Seq.fill(dcacheParams.nWays) {refill_data}), UIntToOH(refill_way).asBools)
   }
 
+  if (env.EnableChiselDB) {
+    val table = ChiselDB.createTable("CacheRefill", new CacheRefillDBEntry)
+    val entry = Wire(new CacheRefillDBEntry)
+    entry.addr  := req_addr
+    entry.way   := refill_way
+    entry.set   := refill_idx
+    table.log(entry, do_refill, "DCache", clock, reset)
+  }
+
   val write_set_idx = io.write.bits.set_idx
   val write_way_idx = io.write.bits.way_idx
 
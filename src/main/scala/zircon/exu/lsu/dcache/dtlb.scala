@@ -236,7 +236,11 @@ class DTLB(nSets: Int, nWays: Int)(implicit p: Parameters) extends BaseZirconMod
   val invalid_way     = OHToUInt(selectFirst(Reverse(Cat(refill_valids.map(!_)))))
   val refill_way      = Mux(has_invalid_way, invalid_way, get_replace_way(plru_array(refill_idx)))
 
-  when (io.ptw.resp.fire && !io.ptw.resp.bits.cause.orR && !io.sfence.valid) {
+  val do_refill = io.ptw.resp.fire && !io.ptw.resp.bits.cause.orR && !io.sfence.valid
+  EventLog(do_refill, LogLevel.INFO, "DTLB Refill", "addr 0x%lx, way %lu, set %lu, data 0x%lx",
+           req_addr, refill_way, refill_idx, refill_data.asUInt)
+
+  when (do_refill) {
     valid_array(refill_idx) := VecInit(valid_array(refill_idx).zipWithIndex map {
       case (v, i) => (i.U === refill_way) || v
     })
@@ -244,6 +248,21 @@ class DTLB(nSets: Int, nWays: Int)(implicit p: Parameters) extends BaseZirconMod
     data_array.write(refill_idx, VecInit(Seq.fill(nWays) {refill_data.asUInt}), UIntToOH(refill_way).asBools)
   }
 
+  if (env.EnableChiselDB) {
+    val table = ChiselDB.createTable("TLBRefill", new TLBRefillDBEntry)
+    val entry = Wire(new TLBRefillDBEntry)
+    entry.vaddr := req_addr
+    entry.asid  := refill_tag.asid
+    entry.prv   := refill_tag.prv
+    entry.level := refill_tag.level
+    entry.ppn   := refill_data.ppn
+    entry.perm  := Cat(refill_data.d, refill_data.a, refill_data.g, refill_data.u,
+                       refill_data.x, refill_data.w, refill_data.r)
+    entry.way   := refill_way
+    entry.set   := refill_idx
+    table.log(entry, do_refill, "DTLB", clock, reset)
+  }
+
   //  Invalidate
   /*  1. If rs1=x0 and rs2=x0, the fence orders all reads and writes made to any
    *     level of the page tables, for all address spaces. The fence also invalidates
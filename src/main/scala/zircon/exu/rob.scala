@@ -13,6 +13,7 @@ package zircon.exu
 
 import chisel3._
 import chisel3.util._
+import chisel3.util.experimental.BoringUtils
 import freechips.rocketchip.config._
 import freechips.rocketchip.rocket.Causes
 import freechips.rocketchip.tile.FPConstants
@@ -90,6 +91,12 @@ class RobPerfs(plWidth: Int)(implicit p: Parameters) extends BaseZirconBundle {
   val ebreak  = Output(Bool())
   val ecall   = Output(Bool())
   val mispred = Output(Bool())
+
+  //  Top-down: why nothing retired this cycle
+  val stall_fe    = Output(Bool())  //  ROB empty
+  val stall_mem   = Output(Bool())  //  Head is a load/store still executing
+  val stall_core  = Output(Bool())  //  Head is any other instruction still executing
+  val bad_spec    = Output(Bool())  //  Pipeline flush
 }
 
 class ROB(plWidth: Int, numIssuePorts: Int, numRobReadPorts: Int)(implicit p: Parameters) extends BaseZirconModule
@@ -812,8 +819,45 @@ class ROB(plWidth: Int, numIssuePorts: Int, numRobReadPorts: Int)(implicit p: Pa
   io.perf.ecall  := ret_valids.head & (ret_metas.head.uopc === UOP_ECALL)
   io.perf.ebreak := ret_valids.head & (ret_metas.head.uopc === UOP_EBREAK)
   io.perf.mispred:= br_state === s_br_flush
+
+  val head_idx   = hashIdx(io.head)
+  val head_empty = !rob_valids(head_idx)
+  val head_mem   = cfi_array(head_idx).is_ld | cfi_array(head_idx).is_st
+  val no_retire  = !io.rets.valid
+  io.perf.bad_spec   := no_retire & io.kill.valid
+  io.perf.stall_fe   := no_retire & !io.kill.valid & head_empty
+  io.perf.stall_mem  := no_retire & !io.kill.valid & !head_empty & head_mem
+  io.perf.stall_core := no_retire & !io.kill.valid & !head_empty & !head_mem
   io.sync        := ret_valids zip ret_cfis map { case (v, i) => v & i.is_sync } reduce (_|_)
 
+  //  Simulation: retired instructions and top-down stall reasons for the harness
+  for (w <- 0 until plWidth) {
+    BoringUtils.addSource(io.rets.valid && ret_valids(w), s"RETIRE_VALID_$w")
+    BoringUtils.addSource(ret_metas(w).addr, s"RETIRE_PC_$w")
+    BoringUtils.addSource(ret_metas(w).ldst_vld && ret_metas(w).ldst_type === RT_FIX, s"RETIRE_WEN_$w")
+    BoringUtils.addSource(ret_metas(w).ldst_lreg, s"RETIRE_RD_$w")
+    BoringUtils.addSource(data_array(hashIdx(ret_idxs(w))).data, s"RETIRE_WDATA_$w")
+    BoringUtils.addSource(ret_cfis(w).is_csr, s"RETIRE_CSR_$w")
+  }
+  BoringUtils.addSource(Cat(io.perf.bad_spec, io.perf.stall_core, io.perf.stall_mem, io.perf.stall_fe), "PMU_TOPDOWN")
+
+  //  ChiselDB
+  if (env.EnableChiselDB) {
+    val table = ChiselDB.createTable("Commit", new CommitDBEntry)
+    for (w <- 0 until plWidth) {
+      val entry = Wire(new CommitDBEntry)
+      entry.pc        := ret_metas(w).addr
+      entry.rob_id    := ret_metas(w).rob_id
+      entry.uopc      := ret_metas(w).uopc
+      entry.rvc       := !ret_metas(w).len
+      entry.rd_valid  := ret_metas(w).ldst_vld
+      entry.rd        := ret_metas(w).ldst_lreg
+      entry.taken     := ret_metas(w).taken
+      entry.target    := ret_metas(w).tg_addr
+      table.log(entry, io.rets.valid && ret_valids(w), s"ROB_$w", clock, reset)
+    }
+  }
+
   //  Difftest
   //  Trap
   if (env.EnableDifftest) {
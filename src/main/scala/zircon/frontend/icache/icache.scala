@@ -177,12 +177,11 @@ class ICacheModule(implicit p: Parameters) extends BaseZirconModule with MemoryO
   //  1.  PTW Response Valid.
   //  2.  Has No Exception.
   //  3.  No Invalidation.
-  when (io.mem.resp.fire && !io.mem.resp.bits.cause.orR && !io.sfence.valid) {
-    printf("[INFO] ICache Refill\n")
-    printf("[INFO]    Address: 0x%x, Way: %d, Set: %d\n", req_addr, refill_way, refill_idx)
-    printf("[INFO]    Data: 0x%x\n", refill_data)
-    //  TODO: Add logger
+  val do_refill = io.mem.resp.fire && !io.mem.resp.bits.cause.orR && !io.sfence.valid
+  EventLog(do_refill, LogLevel.INFO, "ICache Refill", "addr 0x%lx, way %lu, set %lu, data[63:0] 0x%lx",
+           req_addr, refill_way, refill_idx, refill_data(63, 0))
 
+  when (do_refill) {
     for (w <- 0 until icacheParams.nWays) {
       when (w.U === refill_way) {
         tag_array(refill_idx)(w) := refill_tag.asUInt
@@ -191,6 +190,15 @@ class ICacheModule(implicit p: Parameters) extends BaseZirconModule with MemoryO
     data_array.write(refill_idx, VecInit(Seq.fill(icacheParams.nWays) {refill_data}), UIntToOH(refill_way).asBools)
   }
 
+  if (env.EnableChiselDB) {
+    val table = ChiselDB.createTable("CacheRefill", new CacheRefillDBEntry)
+    val entry = Wire(new CacheRefillDBEntry)
+    entry.addr  := req_addr
+    entry.way   := refill_way
+    entry.set   := refill_idx
+    table.log(entry, do_refill, "ICache", clock, reset)
+  }
+
   //  Invalidate Valid when
   //  1.  Invalidate all.
   //  2.  Tag HIT.
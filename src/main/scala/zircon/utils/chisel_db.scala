@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2022 Lyn
+ * Skew is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *         http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+package zircon.utils
+
+import chisel3._
+import chisel3.experimental._
+import freechips.rocketchip.util._
+import scala.collection.mutable
+
+/**
+ * Simulation-only event tables, written to SQLite by the harness (build/test/db.cpp).
+ *
+ * Every log site becomes a DBWriter blackbox (build/test/db.v) that calls one
+ * fixed DPI function with the table id, the site id, the cycle and up to
+ * DBWriter.nCols 64-bit columns. The schema is emitted as chisel_db.h/cpp by
+ * addToElaborationArtefacts.
+ */
+class DBWriter(table: Int, site: Int) extends BlackBox(Map(
+  "TABLE" -> IntParam(table),
+  "SITE"  -> IntParam(site))) {
+  val io = IO(new Bundle() {
+    val clk   = Input(Clock())
+    val en    = Input(Bool())
+    val data  = Input(Vec(DBWriter.nCols, UInt(64.W)))
+  }).suggestName("io")
+}
+
+object DBWriter {
+  val nCols = 8
+}
+
+class Table[T <: Record](val id: Int, val name: String, val hw: T) {
+  //  Bundle elements are kept in reverse declaration order.
+  val fields: Seq[(String, Data)] = hw.elements.toSeq.reverse
+
+  require(fields.size <= DBWriter.nCols, s"Table $name has more than ${DBWriter.nCols} columns")
+  fields.foreach { case (n, d) =>
+    require(d.getWidth <= 64, s"Column $name.$n is wider than 64 bits")
+  }
+
+  def log(data: T, en: Bool, site: String, clock: Clock, reset: Reset): Unit = {
+    val writer = Module(new DBWriter(id, ChiselDB.addSite(site)))
+    writer.io.clk := clock
+    writer.io.en  := en && !reset.asBool
+    writer.io.data := VecInit(fields.map { case (n, _) => data.elements(n).asUInt.pad(64) } ++
+                              Seq.fill(DBWriter.nCols - fields.size) { 0.U(64.W) })
+  }
+}
+
+object ChiselDB {
+  private val tables = mutable.LinkedHashMap[String, Table[_ <: Record]]()
+  private val sites = mutable.ArrayBuffer[String]()
+
+  //  Modules elaborated more than once share the table.
+  def createTable[T <: Record](name: String, hw: T): Table[T] = {
+    tables.get(name) match {
+      case Some(t) =>
+        require(t.fields.map(_._1) == hw.elements.toSeq.reverse.map(_._1), s"Table $name redefined")
+        t.asInstanceOf[Table[T]]
+      case None =>
+        val t = new Table(tables.size, name, hw)
+        tables(name) = t
+        t
+    }
+  }
+
+  def addSite(site: String): Int = {
+    sites += site
+    sites.size - 1
+  }
+
+  def genHeader: String =
+    s"""|#ifndef __CHISEL_DB_H__
+        |#define __CHISEL_DB_H__
+        |
+        |//  Generated by ChiselDB, do not edit.
+        |
+        |#include "db.h"
+        |
+        |${tables.values.map(t => s"#define DB_TABLE_${t.name.toUpperCase} ${t.id}").mkString("\n")}
+        |
+        |#endif
+        |""".stripMargin
+
+  def genCpp: String = {
+    val tableDefs = tables.values.map { t =>
+      val cols = t.fields.map { case (n, _) => "\"" + n + "\"" }.mkString(", ")
+      s"""  { "${t.name}", ${t.fields.size}, { $cols } },"""
+    }
+    val siteDefs = sites.map(s => "  \"" + s + "\",")
+    s"""|//  Generated by ChiselDB, do not edit.
+        |
+        |#include "chisel_db.h"
+        |
+        |const DBTable db_tables[] = {
+        |${tableDefs.mkString("\n")}
+        |  { NULL, 0, {} }
+        |};
+        |const int db_nr_tables = ${tables.size};
+        |
+        |const char *const db_sites[] = {
+        |${siteDefs.mkString("\n")}
+        |  NULL
+        |};
+        |const int db_nr_sites = ${sites.size};
+        |""".stripMargin
+  }
+
+  def addToElaborationArtefacts: Unit = {
+    ElaborationArtefacts.add("h", genHeader)
+    ElaborationArtefacts.add("cpp", genCpp)
+  }
+}
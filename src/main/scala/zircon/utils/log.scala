@@ -10,5 +10,87 @@
  * See the Mulan PubL v2 for more details.
  */
 
-package utils
+package zircon.utils
+
+import chisel3._
+import chisel3.experimental._
+import chisel3.util.experimental.BoringUtils
+import freechips.rocketchip.config._
+import freechips.rocketchip.util._
+import zircon.common._
+import scala.collection.mutable
+
+/**
+ * Binary event log, replaces printf in simulation.
+ *
+ * Every site becomes an EventLogger blackbox (build/test/evlog.v) whose DPI
+ * call appends a fixed-size record to a memory-mapped ring in the harness
+ * (build/test/evlog.cpp). A site fires only inside the log window
+ * (DISPLAY_ENABLE) and when its level is at most the harness log_level, so
+ * outside the window the cost is one branch per site. Names and formats are
+ * emitted as evlog_events.cpp and copied into the log file for evlog-reader.
+ */
+object LogLevel {
+  val ERROR = 1
+  val WARN  = 2
+  val INFO  = 3
+  val DEBUG = 4
+}
+
+class EventLogger(event: Int) extends BlackBox(Map("EVENT" -> IntParam(event))) {
+  val io = IO(new Bundle() {
+    val clk   = Input(Clock())
+    val en    = Input(Bool())
+    val args  = Input(Vec(EventLog.nArgs, UInt(64.W)))
+  }).suggestName("io")
+}
+
+object EventLog {
+  val nArgs = 4
+  val nameLen = 32
+  val fmtLen = 88
+
+  private case class Event(name: String, level: Int, fmt: String, nArgs: Int)
+  private val events = mutable.ArrayBuffer[Event]()
+
+  //  fmt takes the args as uint64_t, e.g. "addr 0x%lx, way %lu".
+  def apply(en: Bool, level: Int, name: String, fmt: String, args: UInt*)(implicit p: Parameters): Unit = {
+    if (!p(DebugOptionsKey).EnableLog) {
+      return
+    }
+    require(args.size <= nArgs, s"Event $name has more than $nArgs arguments")
+    require(name.length < nameLen && fmt.length < fmtLen, s"Event $name: name or format too long")
+    events += Event(name, level, fmt, args.size)
+
+    val display = WireInit(false.B)
+    val log_level = WireInit(0.U(64.W))
+    BoringUtils.addSink(display, "DISPLAY_ENABLE")
+    BoringUtils.addSink(log_level, "DISPLAY_LOG_LEVEL")
+
+    val logger = Module(new EventLogger(events.size - 1))
+    logger.io.clk  := Module.clock
+    logger.io.en   := en && display && log_level >= level.U && !Module.reset.asBool
+    logger.io.args := VecInit(args.map(_.pad(64)) ++ Seq.fill(nArgs - args.size) { 0.U(64.W) })
+  }
+
+  private def quote(s: String) = "\"" + s.replace("\\", "\\\\").replace("\"", "\\\"") + "\""
+
+  def genCpp: String = {
+    val defs = events.map(e => s"  { ${quote(e.name)}, ${quote(e.fmt)}, ${e.level}, ${e.nArgs} },")
+    s"""|//  Generated by EventLog, do not edit.
+        |
+        |#include "evlog.h"
+        |
+        |const EvLogEvent evlog_events[] = {
+        |${defs.mkString("\n")}
+        |  { "", "", 0, 0 }
+        |};
+        |const int evlog_nr_events = ${events.size};
+        |""".stripMargin
+  }
+
+  def addToElaborationArtefacts: Unit = {
+    ElaborationArtefacts.add("evlog.cpp", genCpp)
+  }
+}
 
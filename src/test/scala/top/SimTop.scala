@@ -22,7 +22,53 @@ import freechips.rocketchip.util.{ElaborationArtefacts, HasRocketChipStageUtils}
 import zircon.axi4._
 import zircon.common._
 import zircon.utils._
-import huancun.utils.ChiselDB
+
+class SimRetireIO(implicit p: Parameters) extends BaseZirconBundle {
+  val valid = Bool()
+  val pc    = UInt(vaddrBits.W)
+  val wen   = Bool()              //  Writes an integer register
+  val rd    = UInt(lregSz.W)
+  val wdata = UInt(xLen.W)
+  val csr   = Bool()
+}
+
+class SimTrapIO(implicit p: Parameters) extends BaseZirconBundle {
+  val valid = Bool()
+  val pc    = UInt(vaddrBits.W)
+  val code  = UInt(xLen.W)
+}
+
+//  Architectural state for difftest. gpr lags the retire ports by one cycle.
+class SimDiffIO(implicit p: Parameters) extends BaseZirconBundle {
+  val gpr     = Vec(numLRegs, UInt(xLen.W))
+  val xpt     = Bool()            //  Exception, mret or sret
+  val intr    = Bool()
+  val cause   = UInt(xLen.W)
+  val prv     = UInt(2.W)
+  val mepc    = UInt(xLen.W)
+  val mcause  = UInt(xLen.W)
+  val sepc    = UInt(xLen.W)
+  val scause  = UInt(xLen.W)
+  val satp    = UInt(xLen.W)
+  val mstatus = UInt(xLen.W)
+  val mie     = UInt(xLen.W)
+  val mip     = UInt(xLen.W)
+  val mtvec   = UInt(xLen.W)
+  val stvec   = UInt(xLen.W)
+  val mtval   = UInt(xLen.W)
+  val stval   = UInt(xLen.W)
+  val mscratch = UInt(xLen.W)
+  val sscratch = UInt(xLen.W)
+  val medeleg = UInt(xLen.W)
+  val mideleg = UInt(xLen.W)
+}
+
+class SimPMUIO(implicit p: Parameters) extends BaseZirconBundle {
+  val events  = UInt(32.W)
+  val mdus    = UInt(log2Ceil(retireWidth + 1).W)
+  val fpus    = UInt(log2Ceil(retireWidth + 1).W)
+  val topdown = UInt(4.W)
+}
 
 class SimTop(implicit p: Parameters) extends BaseZirconModule {
     val io = IO(new Bundle() {
@@ -37,6 +83,10 @@ class SimTop(implicit p: Parameters) extends BaseZirconModule {
       val gpio    = Vec(PLICConstants.nGpios, Flipped(new GatewaysIO))
       val pwm     = Vec(PLICConstants.nPwms, Flipped(new GatewaysIO))
       val reset_vector = Input(UInt(vaddrBits.W))
+      val retire  = Output(Vec(retireWidth, new SimRetireIO))
+      val trap    = Output(new SimTrapIO)
+      val pmu     = Output(new SimPMUIO)
+      val diff    = Output(new SimDiffIO)
     })
 
     //  Tile
@@ -53,7 +103,7 @@ class SimTop(implicit p: Parameters) extends BaseZirconModule {
       userBits = 4,
       nBeats = 4
     )
-    val simAXI4Mem = Module(new AXI4Ram(memByte = 1024 * 1024 * 1024, useBlackBox = false))
+    val simAXI4Mem = Module(new AXI4Ram(memByte = 1024 * 1024 * 1024, useBlackBox = true))
     simAXI4Mem.io.node <> core.io.mem_node
 
     //  Devices
@@ -65,7 +115,7 @@ class SimTop(implicit p: Parameters) extends BaseZirconModule {
     core.io.pwm      <> io.pwm
 
     //
-    val log_begin, log_end, log_level = WireInit(0.U(4.W))
+    val log_begin, log_end, log_level = WireInit(0.U(64.W))
     log_begin := io.logCtrl.log_begin
     log_end := io.logCtrl.log_end
     log_level := io.logCtrl.log_level
@@ -73,15 +123,129 @@ class SimTop(implicit p: Parameters) extends BaseZirconModule {
     assert(log_begin <= log_end)
     //
     BoringUtils.addSource((GTimer() >= log_begin) && (GTimer() < log_end), "DISPLAY_ENABLE")
+    BoringUtils.addSource(log_level, "DISPLAY_LOG_LEVEL")
 
     val dummyWire = WireInit(false.B)
     BoringUtils.addSink(dummyWire, "DISPLAY_ENABLE")
 
+    //  Retire
+    for (w <- 0 until retireWidth) {
+      val retire_valid = WireInit(false.B)
+      val retire_pc = WireInit(0.U(vaddrBits.W))
+      val retire_wen = WireInit(false.B)
+      val retire_rd = WireInit(0.U(lregSz.W))
+      val retire_wdata = WireInit(0.U(xLen.W))
+      val retire_csr = WireInit(false.B)
+      BoringUtils.addSink(retire_valid, s"RETIRE_VALID_$w")
+      BoringUtils.addSink(retire_pc, s"RETIRE_PC_$w")
+      BoringUtils.addSink(retire_wen, s"RETIRE_WEN_$w")
+      BoringUtils.addSink(retire_rd, s"RETIRE_RD_$w")
+      BoringUtils.addSink(retire_wdata, s"RETIRE_WDATA_$w")
+      BoringUtils.addSink(retire_csr, s"RETIRE_CSR_$w")
+      io.retire(w).valid := retire_valid
+      io.retire(w).pc := retire_pc
+      io.retire(w).wen := retire_wen
+      io.retire(w).rd := retire_rd
+      io.retire(w).wdata := retire_wdata
+      io.retire(w).csr := retire_csr
+    }
+
+    //  Trap
+    val trap_valid = WireInit(false.B)
+    val trap_pc = WireInit(0.U(vaddrBits.W))
+    val trap_code = WireInit(0.U(xLen.W))
+    BoringUtils.addSink(trap_valid, "TRAP_VALID")
+    BoringUtils.addSink(trap_pc, "TRAP_PC")
+    BoringUtils.addSink(trap_code, "TRAP_CODE")
+    io.trap.valid := trap_valid
+    io.trap.pc := trap_pc
+    io.trap.code := trap_code
+
+    //  PMU
+    val pmu_events = WireInit(0.U(32.W))
+    val pmu_mdus = WireInit(0.U(log2Ceil(retireWidth + 1).W))
+    val pmu_fpus = WireInit(0.U(log2Ceil(retireWidth + 1).W))
+    val pmu_topdown = WireInit(0.U(4.W))
+    BoringUtils.addSink(pmu_events, "PMU_EVENTS")
+    BoringUtils.addSink(pmu_mdus, "PMU_MDUS")
+    BoringUtils.addSink(pmu_fpus, "PMU_FPUS")
+    BoringUtils.addSink(pmu_topdown, "PMU_TOPDOWN")
+    io.pmu.events := pmu_events
+    io.pmu.mdus := pmu_mdus
+    io.pmu.fpus := pmu_fpus
+    io.pmu.topdown := pmu_topdown
+
+    //  Difftest
+    for (i <- 0 until numLRegs) {
+      val gpr = WireInit(0.U(xLen.W))
+      BoringUtils.addSink(gpr, s"DIFF_GPR_$i")
+      io.diff.gpr(i) := gpr
+    }
+    val diff_xpt = WireInit(false.B)
+    val diff_intr = WireInit(false.B)
+    val diff_prv = WireInit(0.U(2.W))
+    val diff_cause, diff_mepc, diff_mcause, diff_sepc, diff_scause, diff_satp = WireInit(0.U(xLen.W))
+    val diff_mstatus, diff_mie, diff_mip, diff_mtvec, diff_stvec, diff_mtval, diff_stval = WireInit(0.U(xLen.W))
+    val diff_mscratch, diff_sscratch, diff_medeleg, diff_mideleg = WireInit(0.U(xLen.W))
+    BoringUtils.addSink(diff_xpt, "DIFF_XPT")
+    BoringUtils.addSink(diff_intr, "DIFF_INTR")
+    BoringUtils.addSink(diff_cause, "DIFF_CAUSE")
+    BoringUtils.addSink(diff_prv, "DIFF_PRV")
+    BoringUtils.addSink(diff_mepc, "DIFF_MEPC")
+    BoringUtils.addSink(diff_mcause, "DIFF_MCAUSE")
+    BoringUtils.addSink(diff_sepc, "DIFF_SEPC")
+    BoringUtils.addSink(diff_scause, "DIFF_SCAUSE")
+    BoringUtils.addSink(diff_satp, "DIFF_SATP")
+    BoringUtils.addSink(diff_mstatus, "DIFF_MSTATUS")
+    BoringUtils.addSink(diff_mie, "DIFF_MIE")
+    BoringUtils.addSink(diff_mip, "DIFF_MIP")
+    BoringUtils.addSink(diff_mtvec, "DIFF_MTVEC")
+    BoringUtils.addSink(diff_stvec, "DIFF_STVEC")
+    BoringUtils.addSink(diff_mtval, "DIFF_MTVAL")
+    BoringUtils.addSink(diff_stval, "DIFF_STVAL")
+    BoringUtils.addSink(diff_mscratch, "DIFF_MSCRATCH")
+    BoringUtils.addSink(diff_sscratch, "DIFF_SSCRATCH")
+    BoringUtils.addSink(diff_medeleg, "DIFF_MEDELEG")
+    BoringUtils.addSink(diff_mideleg, "DIFF_MIDELEG")
+    io.diff.xpt := diff_xpt
+    io.diff.intr := diff_intr
+    io.diff.cause := diff_cause
+    io.diff.prv := diff_prv
+    io.diff.mepc := diff_mepc
+    io.diff.mcause := diff_mcause
+    io.diff.sepc := diff_sepc
+    io.diff.scause := diff_scause
+    io.diff.satp := diff_satp
+    io.diff.mstatus := diff_mstatus
+    io.diff.mie := diff_mie
+    io.diff.mip := diff_mip
+    io.diff.mtvec := diff_mtvec
+    io.diff.stvec := diff_stvec
+    io.diff.mtval := diff_mtval
+    io.diff.stval := diff_stval
+    io.diff.mscratch := diff_mscratch
+    io.diff.sscratch := diff_sscratch
+    io.diff.medeleg := diff_medeleg
+    io.diff.mideleg := diff_mideleg
+
     //
     io.uart.in.valid  := DontCare
     io.uart.out.valid := DontCare
     io.uart.out.ch    := DontCare
 
+    //  Port counts for the harness, which names every retire slot.
+    ElaborationArtefacts.add("sim.h",
+      s"""|#ifndef __SIM_CONFIG_H__
+          |#define __SIM_CONFIG_H__
+          |
+          |//  Generated by SimTop, do not edit.
+          |
+          |#define SIM_RETIRE_WIDTH $retireWidth
+          |#define SIM_FOR_EACH_RETIRE(X) ${(0 until retireWidth).map(w => s"X($w)").mkString(" ")}
+          |
+          |#endif
+          |""".stripMargin)
+
     //  End
 }
 
@@ -90,17 +254,22 @@ object TopMain extends App with HasRocketChipStageUtils {
     val zirconParams: Parameters = ZirconTestUnit.getZirconParameters("ZirconConfig")
     implicit val p: Parameters = zirconParams.alterPartial {
       case TileKey => zirconParams(TileKey)
+      case DebugOptionsKey => zirconParams(DebugOptionsKey).copy(EnableChiselDB = true, EnableLog = true)
     }
     (new ChiselStage).execute(args, Seq(
       ChiselGeneratorAnnotation(() => new SimTop()))
     )
     ChiselDB.addToElaborationArtefacts
+    EventLog.addToElaborationArtefacts
+    //  The ChiselDB schema, the event table and sim_config.h are compiled with the harness.
     ElaborationArtefacts.files.foreach{ case (extension, contents) =>
-      val prefix = extension match {
-        case "h" | "cpp" => "chisel_db"
-        case _ => "Zircon"
+      val (dir, file) = extension match {
+        case "h" | "cpp" => ("./build/test", s"chisel_db.${extension}")
+        case "evlog.cpp" => ("./build/test", "evlog_events.cpp")
+        case "sim.h" => ("./build/test", "sim_config.h")
+        case _ => ("./build", s"Zircon.${extension}")
       }
-      writeOutputFile("./build", s"$prefix.${extension}", contents())
+      writeOutputFile(dir, file, contents())
     }
 
   }